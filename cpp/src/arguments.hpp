@@ -0,0 +1,29 @@
+#ifndef ARGUMENTS_HPP
+#define ARGUMENTS_HPP
+/*
+    Validated reading of numeric command line arguments shared by the drivers
+*/
+
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+// value of i-th command line argument (default if not given), false with message if it is not a number of at least min
+inline bool readArgument(const int argc, char *argv[], const int i, const char *name, const unsigned min, unsigned &value)
+{
+    if (argc <= i)
+        return true;
+    char *end;
+    errno = 0;
+    const long long read = std::strtoll(argv[i], &end, 10);
+    if (end == argv[i] || *end != '\0' || errno != 0 || read < min || read > std::numeric_limits<unsigned>::max())
+    {
+        std::cerr << "Invalid " << name << " '" << argv[i] << "', expected a whole number of at least " << min << std::endl;
+        return false;
+    }
+    value = (unsigned)read;
+    return true;
+}
+
+#endif
@@ -0,0 +1,181 @@
+/*
+    Name:     batch
+    Purpose:  Fits parameters for every job of a manifest (observations, initial guess, scheme, optimizer),
+              jobs run in parallel on a work stealing thread pool.
+    Author:   pavel.macak@fs.cvut.cz
+    Compilation: Makefile is provided - make run6 to run after compilation, make batch to only compile.
+    Command line arguments: manifest file (default 'inputs/manifest.in'), number of threads (default all cores),
+                            summary file (default 'outputs/batch_summary.out')
+    Input files: manifest and files listed in it ('observations?.in', 'parameters_observations?.in')
+    Output files: Yes - one summary line per job
+*/
+
+#include "debug_levels.hpp"
+#include "arguments.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "ode/eulerForward.hpp"
+#include "ode/heun.hpp"
+#include "ode/explicitRK.hpp"
+#include "ode/adaptiveRK.hpp"
+#include "ode/eulerBackward.hpp"
+#include "ode/bdf2.hpp"
+#include "ode/trbdf2.hpp"
+#include "ode/rosenbrock.hpp"
+
+#include "parallel/workStealingPool.hpp"
+#include "siqrd/runParamSearch.hpp"
+#include "siqrd/odeSys_siqrd.hpp"
+
+typedef double working_precision;
+
+// one line of manifest and its result
+struct Job
+{
+    std::string observations, guess, scheme, optimizer;
+    ublas::vector<working_precision> params = ublas::scalar_vector<working_precision>(5, std::numeric_limits<working_precision>::quiet_NaN());
+    working_precision lse = std::numeric_limits<working_precision>::quiet_NaN();
+    optimization::Report report;
+    double wall_time = 0.0;
+    bool failed = false; // observations or initial guess could not be read, or optimizer cannot be used with scheme
+};
+
+// reads jobs, lines starting with # are comments, returns false on unknown scheme or optimizer
+bool readManifest(const std::string &manifest_file, std::vector<Job> &jobs)
+{
+    std::ifstream file(manifest_file);
+    if (!file)
+    {
+        std::cerr << "Cannot open manifest " << manifest_file << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream words(line);
+        Job job;
+        if (!(words >> job.observations) || job.observations[0] == '#')
+            continue;
+        words >> job.guess >> job.scheme >> job.optimizer;
+        if ((job.scheme != "fwe" && job.scheme != "bwe" && job.scheme != "heun" && job.scheme != "rk4" &&
+             job.scheme != "bs3" && job.scheme != "dopri5" && job.scheme != "dopri5_adaptive" && job.scheme != "bdf2" &&
+             job.scheme != "trbdf2" && job.scheme != "ros2" && job.scheme != "rodas3") ||
+            (job.optimizer != "bfgs" && job.optimizer != "cgm" && job.optimizer != "lm" &&
+             job.optimizer != "lbfgsb" && job.optimizer != "lbfgsb_log"))
+        {
+            std::cerr << "Invalid manifest line: " << line << std::endl;
+            return false;
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+void runJob(Job &job, const working_precision tol)
+{
+    typedef typename ode::EulerForward<siqrd::OdeSys_SIQRD<working_precision>> fwe;
+    typedef typename ode::EulerBackward<siqrd::OdeSys_SIQRD<working_precision>, ode::simplified_newton> bwe;
+    typedef typename ode::Heun<siqrd::OdeSys_SIQRD<working_precision>> heun;
+    typedef typename ode::RK4<siqrd::OdeSys_SIQRD<working_precision>> rk4;
+    typedef typename ode::BogackiShampine<siqrd::OdeSys_SIQRD<working_precision>> bs3;
+    typedef typename ode::DormandPrince<siqrd::OdeSys_SIQRD<working_precision>> dopri5;
+    typedef typename ode::AdaptiveDormandPrince<siqrd::OdeSys_SIQRD<working_precision>> dopri5_adaptive;
+    typedef typename ode::BDF2<siqrd::OdeSys_SIQRD<working_precision>, ode::simplified_newton> bdf2;
+    typedef typename ode::TrBdf2<siqrd::OdeSys_SIQRD<working_precision>, ode::simplified_newton> trbdf2;
+    typedef typename ode::Ros2<siqrd::OdeSys_SIQRD<working_precision>> ros2;
+    typedef typename ode::Rodas3<siqrd::OdeSys_SIQRD<working_precision>> rodas3;
+
+    const std::string observ_file = siqrd::observationFile("inputs/", job.observations),
+                      param_file = "inputs/" + job.guess + ".in";
+    const siqrd::Optimizer optimizer = job.optimizer == "bfgs"     ? siqrd::Optimizer::bfgs
+                                       : job.optimizer == "cgm"    ? siqrd::Optimizer::cgm
+                                       : job.optimizer == "lm"     ? siqrd::Optimizer::lm
+                                       : job.optimizer == "lbfgsb" ? siqrd::Optimizer::lbfgsb
+                                                                   : siqrd::Optimizer::lbfgsb_log;
+
+    const auto start = std::chrono::steady_clock::now();
+    if (job.scheme == "fwe")
+        job.failed = !siqrd::fitParameters<fwe>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "bwe")
+        job.failed = !siqrd::fitParameters<bwe>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "rk4")
+        job.failed = !siqrd::fitParameters<rk4>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "bs3")
+        job.failed = !siqrd::fitParameters<bs3>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "dopri5")
+        job.failed = !siqrd::fitParameters<dopri5>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "dopri5_adaptive")
+        job.failed = !siqrd::fitParameters<dopri5_adaptive>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "bdf2")
+        job.failed = !siqrd::fitParameters<bdf2>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "trbdf2")
+        job.failed = !siqrd::fitParameters<trbdf2>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "ros2")
+        job.failed = !siqrd::fitParameters<ros2>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else if (job.scheme == "rodas3")
+        job.failed = !siqrd::fitParameters<rodas3>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    else
+        job.failed = !siqrd::fitParameters<heun>(observ_file, param_file, tol, optimizer, job.params, job.lse, job.report);
+    job.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    const working_precision tol = 1e-7;
+    const std::string manifest_file = argc > 1 ? argv[1] : "inputs/manifest.in";
+    unsigned no_threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!readArgument(argc, argv, 2, "number of threads", 1, no_threads))
+        return 1;
+    const std::string summary_file = argc > 3 ? argv[3] : "outputs/batch_summary.out";
+
+    std::vector<Job> jobs;
+    if (!readManifest(manifest_file, jobs))
+        return 1;
+    std::cout << "Running " << jobs.size() << " jobs on " << no_threads << " threads." << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    parallel::WorkStealingPool pool(no_threads);
+    auto task = [&jobs, tol](const std::size_t i, const std::size_t) { runJob(jobs[i], tol); };
+    pool.run(jobs.size(), task);
+    const double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // parameters in file order beta mu gamma alpha delta
+    std::ofstream file(summary_file);
+    // converged is -1 for jobs that could not be run
+    file << "# observations  guess  scheme  optimizer  converged  iterations  wall_time[s]  LSE  beta  mu  gamma  alpha  delta" << std::endl;
+    std::size_t no_converged = 0, no_failed = 0;
+    for (const auto &job : jobs)
+    {
+        file << job.observations << "  \t" << job.guess << "  \t" << job.scheme << "  \t" << job.optimizer << "  \t"
+             << (job.failed ? -1 : (int)job.report.converged) << "  \t" << job.report.iterations << "  \t" << job.wall_time << "  \t" << job.lse;
+        for (const auto i : {1, 4, 2, 0, 3})
+            file << "  \t" << job.params[i];
+        file << std::endl;
+        no_converged += job.report.converged;
+        no_failed += job.failed;
+    }
+    file.close();
+    if (!file)
+    {
+        std::cerr << "Cannot write summary file " << summary_file << std::endl;
+        return 1;
+    }
+
+    std::cout << no_converged << " of " << jobs.size() << " jobs converged";
+    if (no_failed > 0)
+        std::cout << ", " << no_failed << " could not be run";
+    std::cout << " in " << wall_time << " s, summary written to " << summary_file << std::endl;
+    return no_converged == jobs.size() ? 0 : 1;
+}
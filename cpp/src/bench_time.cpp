@@ -1,22 +1,22 @@
 /*
     Name:     bench_time
-    Purpose:  Timing program, switching between CGM and BFGS hardcoded.
+    Purpose:  Timing suite - time steps of all schemes, whole solves for several N, LSE value and gradients,
+              line search, full BFGS and CGM runs and I/O, each timed separately without file parsing.
     Author:   pavel.macak@fs.cvut.cz
     Compilation: Makefile is provided - make time to run after compilation, make bench_time to only compile
-    Command line arguments: None
-    Input files: 'parameters_observations1.in'
-    Output files: Yes
-
-    My configuration    (average, standard deviation)
-    heun CGM Time(s):   0.23418   0.0111761
-    heun BFGS Time(s):  0.0376051 0.00203765
+    Command line arguments: (0-2) Output JSON file (default 'outputs/bench_time.json', '-' for standard output)
+                            and filter - only benchmarks whose name contains it are run.
+    Input files: 'observations?', 'parameters_observations?.in'
+    Output files: JSON with minimum, 5, 25, 50, 75 and 95 percentile, maximum and mean time per call (s)
+                  and profiling counters per call
 */
 
 #include "debug_levels.hpp"
 
+#include <cassert>
+#include <fstream>
 #include <iostream>
 #include <string>
-#include <chrono>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
@@ -25,62 +25,166 @@ namespace ublas = boost::numeric::ublas;
 #include "ode/eulerForward.hpp"
 #include "ode/heun.hpp"
 #include "ode/eulerBackward.hpp"
+#include "ode/explicitRK.hpp"
+#include "ode/bdf2.hpp"
+#include "ode/trbdf2.hpp"
+#include "ode/rosenbrock.hpp"
+#include "ode/odeSolver.hpp"
 
-#include "siqrd/runParamSearch.hpp"
 #include "siqrd/odeSys_siqrd.hpp"
+#include "siqrd/observations.hpp"
+#include "siqrd/runParamSearch.hpp"
+#include "optimization/lineSearch.hpp"
+#include "saving/saveResults.hpp"
+#include "saving/binaryResults.hpp"
+#include "benchmark/benchmark.hpp"
+
+typedef double working_precision;
+typedef siqrd::OdeSys_SIQRD<working_precision> siqrd_system;
+typedef typename ode::EulerForward<siqrd_system> fwe;
+typedef typename ode::EulerBackward<siqrd_system> bwe;
+typedef typename ode::EulerBackward<siqrd_system, ode::simplified_newton> bwe_simplified;
+typedef typename ode::Heun<siqrd_system> heun;
+typedef typename ode::RK4<siqrd_system> rk4;
+typedef typename ode::DormandPrince<siqrd_system> dopri5;
+typedef typename ode::BDF2<siqrd_system, ode::simplified_newton> bdf2;
+typedef typename ode::TrBdf2<siqrd_system, ode::simplified_newton> trbdf2;
+typedef typename ode::Ros2<siqrd_system> ros2;
+typedef typename ode::Rodas3<siqrd_system> rodas3;
+
+const std::string observ_file = siqrd::observationFile("inputs/", "observations1"),
+                  param_file = "inputs/parameters_observations1.in",
+                  observ_file2 = siqrd::observationFile("inputs/", "observations2"),
+                  param_file2 = "inputs/parameters_observations2.in";
+
+// one step from the initial condition with time step of estimation runs (T = 100, N = 1000)
+template <typename scheme>
+void bench_time_step(benchmark::Suite &suite, const std::string &label, siqrd_system &eqns)
+{
+    scheme method(1000, 100.0);
+    const auto old_time = eqns.initial_condition();
+    auto new_time = old_time;
+    suite.run("time_step/" + label, [&]() {
+        method.time_step(eqns, old_time, new_time);
+        benchmark::do_not_optimize(new_time);
+    });
+}
 
-int main()
+template <typename scheme>
+void bench_solve(benchmark::Suite &suite, const std::string &label, siqrd_system &eqns, const int N)
 {
-    typedef double working_precision;
-    // typedef typename ode::EulerForward<siqrd::OdeSys_SIQRD<working_precision>> fwe;
-    // typedef typename ode::EulerBackward<siqrd::OdeSys_SIQRD<working_precision>> bwe;
-    typedef typename ode::Heun<siqrd::OdeSys_SIQRD<working_precision>> heun;
+    ode::OdeSolver<scheme> solver(N, 100.0);
+    ublas::matrix<working_precision, ublas::column_major> results(siqrd_system::dim, N + 1);
+    suite.run("solve/" + label + "/" + std::to_string(N), [&]() {
+        solver.solve(eqns, results);
+        benchmark::do_not_optimize(results(0, N));
+    });
+}
 
-#ifndef NINFO
-    std::cout << "Program started." << std::endl
-              << std::endl;
-#endif
+template <typename scheme>
+void bench_optimizers(benchmark::Suite &suite, const std::string &label, const working_precision tol,
+                      const std::string &observations = observ_file, const std::string &parameters = param_file)
+{
+    const std::string prefix = "optimize/" + label;
+    siqrd::LSE_siqrd<scheme> lse(observations, parameters);
+    const auto start = lse.get_eqns().parameters();
+    suite.run(prefix + "/bfgs", [&]() {
+        optimization::CachedTarget<decltype(lse)> cached_target(lse);
+        benchmark::do_not_optimize(optimization::BFGS(cached_target, start, tol));
+    });
+    suite.run(prefix + "/cgm", [&]() {
+        optimization::CachedTarget<decltype(lse)> cached_target(lse);
+        benchmark::do_not_optimize(optimization::CGM<optimization::FR_formula>(cached_target, start, tol));
+    });
+}
 
-    const working_precision tol = 1e-7;
-    const std::string observations = "observations1",
-                      starting_guess = "parameters_" + observations;
-
-    int number_exp = 100;
-    int discard = 5;
-    double elapsed_time = 0.;
-    double average_time = 0.;
-    double squared_time = 0.;
-    double time_diff = 0.;
-    for (int exp = 0; exp < number_exp + discard; exp++)
+int main(int argc, char const *argv[])
+{
+    assert(argc <= 3);
+    const std::string json_file = argc > 1 ? argv[1] : "outputs/bench_time.json",
+                      filter = argc > 2 ? argv[2] : "";
+    benchmark::Suite suite(filter);
+
+    siqrd_system eqns(param_file);
+    bench_time_step<fwe>(suite, "fwe", eqns);
+    bench_time_step<bwe>(suite, "bwe", eqns);
+    bench_time_step<bwe_simplified>(suite, "bwe_simplified", eqns);
+    bench_time_step<heun>(suite, "heun", eqns);
+    bench_time_step<rk4>(suite, "rk4", eqns);
+    bench_time_step<dopri5>(suite, "dopri5", eqns);
+    bench_time_step<trbdf2>(suite, "trbdf2", eqns);
+    bench_time_step<ros2>(suite, "ros2", eqns);
+    bench_time_step<rodas3>(suite, "rodas3", eqns);
+
+    for (const int N : {100, 1000, 10000})
     {
-        auto t_start = std::chrono::high_resolution_clock::now();
-
-
-
-/****************************TIMED BLOCK****************************/
-
-
-        // siqrd::runCGM<heun>(observations, starting_guess, tol);
-        siqrd::runBFGS<heun>(observations, starting_guess, tol);
-
-
-/*******************************************************************/
-
-
+        bench_solve<fwe>(suite, "fwe", eqns, N);
+        bench_solve<bwe>(suite, "bwe", eqns, N);
+        bench_solve<bwe_simplified>(suite, "bwe_simplified", eqns, N);
+        bench_solve<heun>(suite, "heun", eqns, N);
+        bench_solve<rk4>(suite, "rk4", eqns, N);
+        bench_solve<bdf2>(suite, "bdf2", eqns, N); // multistep, time_step alone would only repeat its starting step
+        bench_solve<trbdf2>(suite, "trbdf2", eqns, N);
+        bench_solve<ros2>(suite, "ros2", eqns, N);
+        bench_solve<rodas3>(suite, "rodas3", eqns, N);
+    }
 
-        auto t_end = std::chrono::high_resolution_clock::now();
-        if (exp >= discard)
-        {
-            elapsed_time = std::chrono::duration<double>(t_end - t_start).count();
-            time_diff = elapsed_time - average_time;
-            average_time += time_diff / (exp - discard + 1);
-            squared_time += time_diff * time_diff;
-        }
+    siqrd::LSE_siqrd<heun> lse(observ_file, param_file);
+    const auto parameters = lse.get_eqns().parameters();
+    ublas::vector<working_precision> gradient(parameters.size());
+    suite.run("lse/heun/value", [&]() { benchmark::do_not_optimize(lse(parameters)); });
+    const working_precision lse_0 = lse(parameters);
+    const std::pair<siqrd::GradientMethod, const char *> gradient_methods[] = {
+        {siqrd::GradientMethod::forward_difference, "forward_difference"},
+        {siqrd::GradientMethod::central_difference, "central_difference"},
+        {siqrd::GradientMethod::sensitivity, "sensitivity"},
+        {siqrd::GradientMethod::adjoint, "adjoint"}};
+    for (const auto &method : gradient_methods)
+    {
+        lse.set_gradient(method.first);
+        suite.run(std::string("lse/heun/gradient/") + method.second, [&]() {
+            lse.gradient(parameters, lse_0, gradient);
+            benchmark::do_not_optimize(gradient);
+        });
     }
-    std::cout << "Time(s): " << average_time << " " << std::sqrt(squared_time / (number_exp - 1)) << std::endl;
 
+    // steepest descent step from the starting guess
+    lse.set_gradient(siqrd::GradientMethod::forward_difference);
+    lse.gradient(parameters, lse_0, gradient);
+    const ublas::vector<working_precision> direction = -gradient;
+    optimization::LineSearch<ublas::vector<working_precision>> line_search(parameters.size(), 1e-5);
+    suite.run("line_search/heun", [&]() {
+        benchmark::do_not_optimize(line_search(parameters, direction, lse_0, gradient, lse, 1.0));
+    });
+
+    bench_optimizers<heun>(suite, "heun", 1e-7);
+    bench_optimizers<rk4>(suite, "rk4", 1e-7);
+    bench_optimizers<bwe_simplified>(suite, "bwe_simplified", 1e-7);
+    // full and simplified newton on the second case, counters give factorizations per time step
+    bench_optimizers<bwe>(suite, "bwe/observations2", 1e-7, observ_file2, param_file2);
+    bench_optimizers<bwe_simplified>(suite, "bwe_simplified/observations2", 1e-7, observ_file2, param_file2);
+
+    suite.run("io/read_observations", [&]() {
+        siqrd::Observations<working_precision> observations(observ_file);
+        benchmark::do_not_optimize(observations.data());
+    });
+    ublas::matrix<working_precision, ublas::column_major> results(siqrd_system::dim, 10001);
+    ode::OdeSolver<heun>(10000, 100.0).solve(eqns, results);
+    suite.run("io/save_results/text", [&]() { saving::saveResults(0.01, results, std::string("outputs/bench_time.out")); });
+    suite.run("io/save_results/binary", [&]() { saving::saveResultsBinary(0.01, results, std::string("outputs/bench_time.bin")); });
+    suite.run("io/save_results/quantized", [&]() { saving::saveResultsBinary(0.01, results, std::string("outputs/bench_time.bin"), 1, 1e-6); });
+
+    if (json_file == "-")
+    {
+        suite.write_json(std::cout);
+    }
+    else
+    {
+        std::ofstream file(json_file);
+        suite.write_json(file);
 #ifndef NINFO
-    std::cout << "Program finished." << std::endl;
+        std::cout << "Results written to " << json_file << std::endl;
 #endif
+    }
     return 0;
 }
@@ -0,0 +1,168 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+/*
+    Minimal benchmark harness - every case is calibrated so that one sample takes at least min_sample_time,
+    timed for a number of samples after warm-up, and reported per call as percentiles of the samples.
+    Results are written as JSON so that runs of different builds can be compared, together with profiling
+    counters per call (e.g. factorizations and time steps of implicit schemes).
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../profiling/counters.hpp"
+
+namespace benchmark
+{
+    // keeps computation of value from being optimized away
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        asm volatile(""
+                     :
+                     : "r"(&value)
+                     : "memory");
+    }
+
+    struct Result
+    {
+        std::string name;
+        std::size_t samples, calls_per_sample;
+        double min, p5, p25, median, p75, p95, max, mean; // seconds per call
+        std::vector<std::pair<std::string, double>> counters; // nonzero profiling events per call
+    };
+
+    // linear interpolation between order statistics of sorted values, q in [0, 1]
+    inline double percentile(const std::vector<double> &sorted, const double q)
+    {
+        const double position = q * (sorted.size() - 1);
+        const std::size_t below = (std::size_t)position;
+        if (below + 1 >= sorted.size())
+            return sorted.back();
+        return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+    }
+
+    /*
+////Uses concepts:
+case_functor
+    member functions:
+        void operator()()           one call of benchmarked code
+    */
+    class Suite
+    {
+    public:
+        typedef std::size_t size_type;
+
+    private:
+        std::vector<Result> results_;
+        std::string filter_;
+        size_type samples_, warmup_;
+        double min_sample_time_;
+
+    public:
+        // only cases whose name contains filter are run
+        Suite(const std::string &filter = "", const size_type samples = 21, const size_type warmup = 2,
+              const double min_sample_time = 0.01)
+            : filter_(filter), samples_(samples), warmup_(warmup), min_sample_time_(min_sample_time){};
+        ~Suite(){};
+
+    public:
+        const std::vector<Result> &results() const { return results_; }
+
+        template <typename case_functor>
+        void run(const std::string &name, case_functor call)
+        {
+            if (name.find(filter_) == std::string::npos)
+                return;
+#ifndef NINFO
+            std::cerr << name << "...       ";
+#endif
+            typedef std::chrono::steady_clock clock;
+            // calibration doubles calls per sample until a sample is long enough, also warms caches
+            size_type calls = 1;
+            while (true)
+            {
+                const auto start = clock::now();
+                for (size_type i = 0; i < calls; i++)
+                    call();
+                if (std::chrono::duration<double>(clock::now() - start).count() >= min_sample_time_)
+                    break;
+                calls *= 2;
+            }
+
+            std::vector<double> times(samples_);
+            const profiling::Totals before = profiling::totals();
+            for (size_type s = 0; s < warmup_ + samples_; s++)
+            {
+                const auto start = clock::now();
+                for (size_type i = 0; i < calls; i++)
+                    call();
+                const double time = std::chrono::duration<double>(clock::now() - start).count() / calls;
+                if (s >= warmup_)
+                    times[s - warmup_] = time;
+            }
+            const profiling::Totals counted = profiling::totals() - before;
+            std::sort(times.begin(), times.end());
+
+            Result result;
+            result.name = name;
+            result.samples = samples_;
+            result.calls_per_sample = calls;
+            result.min = times.front();
+            result.p5 = percentile(times, 0.05);
+            result.p25 = percentile(times, 0.25);
+            result.median = percentile(times, 0.5);
+            result.p75 = percentile(times, 0.75);
+            result.p95 = percentile(times, 0.95);
+            result.max = times.back();
+            result.mean = 0.0;
+            for (const double t : times)
+                result.mean += t / samples_;
+            for (unsigned i = 0; i < (unsigned)profiling::Event::count; i++)
+            {
+                if (counted.events[i] != 0)
+                    result.counters.emplace_back(profiling::event_names[i], (double)counted.events[i] / (calls * (warmup_ + samples_)));
+            }
+            results_.push_back(result);
+#ifndef NINFO
+            std::cerr << result.median << " s" << std::endl;
+#endif
+        }
+
+        void write_json(std::ostream &out) const
+        {
+            const std::time_t now = std::time(nullptr);
+            char date[32];
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+            out << "{\n  \"context\": {\"date\": \"" << date << "\", \"compiler\": \"" << __VERSION__
+                << "\", \"ndebug\": " <<
+#ifdef NDEBUG
+                "true"
+#else
+                "false"
+#endif
+                << ", \"unit\": \"s\"},\n  \"benchmarks\": [";
+            for (size_type i = 0; i < results_.size(); i++)
+            {
+                const Result &r = results_[i];
+                out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"samples\": " << r.samples
+                    << ", \"calls_per_sample\": " << r.calls_per_sample
+                    << ", \"min\": " << r.min << ", \"p5\": " << r.p5 << ", \"p25\": " << r.p25
+                    << ", \"median\": " << r.median << ", \"p75\": " << r.p75 << ", \"p95\": " << r.p95
+                    << ", \"max\": " << r.max << ", \"mean\": " << r.mean << ", \"counters\": {";
+                for (size_type j = 0; j < r.counters.size(); j++)
+                    out << (j ? ", " : "") << "\"" << r.counters[j].first << "\": " << r.counters[j].second;
+                out << "}}";
+            }
+            out << "\n  ]\n}" << std::endl;
+        }
+    };
+} // namespace benchmark
+
+#endif
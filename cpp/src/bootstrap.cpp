@@ -0,0 +1,68 @@
+/*
+    Name:     bootstrap
+    Purpose:  Confidence intervals of parameters fitted with Levenberg-Marquardt and Heun's method on both example cases of observations,
+              from refits of the fitted solution with resampled residuals (single days or blocks of days), run in parallel.
+    Author:   pavel.macak@fs.cvut.cz
+    Compilation: Makefile is provided - make run7 to run after compilation, make bootstrap to only compile.
+    Command line arguments: number of replicates (default 200), block length in days (default 1 - independent days,
+                            shorter than observed period), number of threads (default all cores), seed (default 0)
+    Input files: 'parameters_observations?.in', 'observations?.in'
+    Output files: Yes
+*/
+
+#include "debug_levels.hpp"
+#include "arguments.hpp"
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "ode/heun.hpp"
+
+#include "siqrd/runParamSearch.hpp"
+#include "siqrd/odeSys_siqrd.hpp"
+
+template <typename result_type>
+void printSummary(const std::string &observations, const result_type &result)
+{
+    const char *const names[] = {"alpha", "beta", "gamma", "delta", "mu"};
+    std::cout << observations << ": " << result.replicates.size2() << " replicates, " << result.no_converged()
+              << " of them converged, " << 100 * result.confidence << "% percentile intervals" << std::endl;
+    for (unsigned i = 0; i < result.estimate.size(); i++)
+    {
+        std::cout << "  " << names[i] << ":\t" << result.estimate[i] << "\t[" << result.lower[i] << ", "
+                  << result.upper[i] << "]\tmedian " << result.median[i] << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    typedef double working_precision;
+    const working_precision tol = 1e-7, confidence = 0.95;
+
+    unsigned no_replicates = 200, block_length = 1, no_threads = std::max(1u, std::thread::hardware_concurrency()), seed = 0;
+    if (!readArgument(argc, argv, 1, "number of replicates", 1, no_replicates) ||
+        !readArgument(argc, argv, 2, "block length", 1, block_length) ||
+        !readArgument(argc, argv, 3, "number of threads", 1, no_threads) ||
+        !readArgument(argc, argv, 4, "seed", 0, seed))
+    {
+        return 1;
+    }
+#ifdef DLVL0
+    std::cout << "Replicates: " << no_replicates << ", block length: " << block_length << ", threads: " << no_threads << std::endl;
+#endif
+
+    typedef typename ode::Heun<siqrd::OdeSys_SIQRD<working_precision>> heun;
+    for (const std::string observations : {"observations1", "observations2"})
+    {
+        auto result = siqrd::runBootstrap<heun>(observations, "parameters_" + observations, no_replicates, tol,
+                                                block_length, confidence, siqrd::Optimizer::lm, no_threads, seed);
+        printSummary(observations, result);
+    }
+
+    return 0;
+}
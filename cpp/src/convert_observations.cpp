@@ -0,0 +1,54 @@
+/*
+    Name:     convert_observations
+    Purpose:  Converts observations from text '.in' format to binary '.obs' format, which LSE maps without parsing.
+    Author:   pavel.macak@fs.cvut.cz
+    Compilation: Makefile is provided - make convert to convert the example inputs, make convert_observations to only compile.
+    Command line arguments: input file, output file, optionally stored value type (float, double or long_double; default double)
+    Input files: Any observation file (text or binary)
+    Output files: Yes
+*/
+
+#include "debug_levels.hpp"
+
+#include <iostream>
+#include <string>
+
+#include "siqrd/observations.hpp"
+
+// returns false if input_file cannot be read or output_file cannot be written
+template <typename value_type>
+bool convert(const std::string &input_file, const std::string &output_file)
+{
+    siqrd::Observations<value_type> observations(input_file);
+    if (!observations.good() || !observations.write_binary(output_file))
+        return false;
+#ifndef NINFO
+    std::cout << "Converted " << observations.no_days() << " days of " << observations.dim() << " compartments from "
+              << input_file << " to " << output_file << std::endl;
+#endif
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " input_file output_file [float|double|long_double]" << std::endl;
+        return 1;
+    }
+    const std::string value_type = argc > 3 ? argv[3] : "double";
+
+    bool converted;
+    if (value_type == "float")
+        converted = convert<float>(argv[1], argv[2]);
+    else if (value_type == "double")
+        converted = convert<double>(argv[1], argv[2]);
+    else if (value_type == "long_double")
+        converted = convert<long double>(argv[1], argv[2]);
+    else
+    {
+        std::cerr << "Unknown value type " << value_type << std::endl;
+        return 1;
+    }
+    return converted ? 0 : 1;
+}
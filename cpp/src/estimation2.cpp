@@ -1,6 +1,6 @@
 /*
     Name:     estimation2
-    Purpose:  Runs BFGS with all methods on first example case of observations.
+    Purpose:  Runs BFGS, Levenberg-Marquardt and L-BFGS-B (also in log space) with all methods on first example case of observations.
     Author:   pavel.macak@fs.cvut.cz
     Compilation: Makefile is provided - make run4 to run after compilation, make estimation2 to only compile
     Command line arguments: None
@@ -38,13 +38,24 @@ int main()
                       starting_guess1 = "parameters_" + observations1;
 
     typedef typename ode::EulerForward<siqrd::OdeSys_SIQRD<working_precision>> fwe;
-    typedef typename ode::EulerBackward<siqrd::OdeSys_SIQRD<working_precision>> bwe;
+    typedef typename ode::EulerBackward<siqrd::OdeSys_SIQRD<working_precision>, ode::simplified_newton> bwe;
     typedef typename ode::Heun<siqrd::OdeSys_SIQRD<working_precision>> heun;
 
     siqrd::runBFGS<heun>(observations1, starting_guess1, tol);
     siqrd::runBFGS<fwe>(observations1, starting_guess1, tol);
     siqrd::runBFGS<bwe>(observations1, starting_guess1, tol);
 
+    siqrd::runLM<heun>(observations1, starting_guess1, tol);
+    siqrd::runLM<fwe>(observations1, starting_guess1, tol);
+    siqrd::runLM<bwe>(observations1, starting_guess1, tol);
+
+    for (const bool log_space : {false, true})
+    {
+        siqrd::runLBFGSB<heun>(observations1, starting_guess1, tol, log_space);
+        siqrd::runLBFGSB<fwe>(observations1, starting_guess1, tol, log_space);
+        siqrd::runLBFGSB<bwe>(observations1, starting_guess1, tol, log_space);
+    }
+
 
 #ifndef NINFO
     std::cout << "Program finished." << std::endl;
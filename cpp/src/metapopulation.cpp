@@ -0,0 +1,82 @@
+/*
+    Name:     metapopulation
+    Purpose:  Simulates 1000 SIQRD regions coupled by mobility (dim 5000) with all methods, infection starts in region 0.
+              Backward Euler factorizes the sparse jacobian, no dim x dim matrix is allocated, and is compared
+              with Jacobian-free Newton-Krylov backward Euler (bwe_jfnk), which uses right hand side only.
+    Author:   pavel.macak@fs.cvut.cz
+    Compilation: Makefile is provided - make run9 to run after compilation, make metapopulation to only compile.
+    Command line arguments: (0-3) Number of time steps (default 1000), final simulation time (default 100)
+                            and mobility file (lines: from to rate, default ring of regions with rate 0.01).
+    Input files: 'parameters.in'
+    Output files: Yes - sums of compartments over all regions
+*/
+
+#include "debug_levels.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "siqrd/odeSys_siqrd_meta.hpp"
+#include "ode/odeSolver.hpp"
+#include "ode/eulerForward.hpp"
+#include "ode/heun.hpp"
+#include "ode/eulerBackward.hpp"
+#include "saving/saveResults.hpp"
+
+typedef double working_precision;
+typedef siqrd::OdeSys_SIQRD_meta<1000, working_precision> meta_system;
+
+// streaming solve, only sums over regions are kept
+template <typename scheme>
+void simulate(meta_system &eqns, const int N, const working_precision T, const std::string &name = scheme::method_name)
+{
+    typedef typename meta_system::size_type size_type;
+    ode::OdeSolver<scheme> solver(N, T);
+    ublas::matrix<working_precision, ublas::column_major> totals(meta_system::compartments, N + 1);
+    working_precision last_infected = 0.0;
+    auto sum_regions = [&totals, &last_infected](const size_type step, const auto &state) {
+        for (size_type c = 0; c < meta_system::compartments; c++)
+        {
+            working_precision sum = 0.0;
+            for (size_type r = 0; r < meta_system::regions; r++)
+                sum += state[c * meta_system::regions + r];
+            totals(c, step) = sum;
+        }
+        last_infected = state[2 * meta_system::regions - 1];
+    };
+    const auto start = std::chrono::steady_clock::now();
+    solver.solve(eqns, sum_regions);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+#ifndef NINFO
+    std::cout << name << ": " << elapsed.count() << " s, infected in total " << totals(1, N)
+              << ", in last region " << last_infected << std::endl;
+#endif
+    saving::saveResults(T / N, totals, std::string("outputs/") + name + "_metapopulation.out");
+}
+
+int main(int argc, char const *argv[])
+{
+    assert(argc <= 4);
+    const int N = argc > 1 ? std::stoi(argv[1]) : 1000;
+    const working_precision T = argc > 2 ? std::stod(argv[2]) : 100.0;
+    assert(N > 0);
+    assert(T > 0);
+
+    const auto links = argc > 3 ? siqrd::readMobility(argv[3], meta_system::regions) : siqrd::ringMobility(meta_system::regions, 0.01);
+    meta_system eqns("inputs/parameters.in", links);
+#ifdef DLVL0
+    std::cout << meta_system::regions << " regions, " << links.size() << " mobility links, dim " << meta_system::dim << std::endl;
+#endif
+
+    simulate<ode::EulerForward<meta_system>>(eqns, N, T);
+    simulate<ode::Heun<meta_system>>(eqns, N, T);
+    simulate<ode::EulerBackward<meta_system>>(eqns, N, T);
+    simulate<ode::EulerBackward<meta_system, ode::full_newton, ode::matrix_free>>(eqns, N, T, "bwe_jfnk");
+    return 0;
+}
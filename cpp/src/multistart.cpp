@@ -0,0 +1,75 @@
+/*
+    Name:     multistart
+    Purpose:  Runs BFGS with Heun's method from many starting guesses on both example cases of observations.
+    Author:   pavel.macak@fs.cvut.cz
+    Compilation: Makefile is provided - make run5 to run after compilation, make multistart to only compile.
+    Command line arguments: number of starting guesses (default 32), number of threads (default all cores),
+                            candidates per starting guess screened by batched LSE (default 4)
+    Input files: 'parameter_bounds.in', 'parameters_observations?.in', 'observations?.in'
+    Output files: Yes
+*/
+
+#include "debug_levels.hpp"
+#include "arguments.hpp"
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <boost/numeric/ublas/io.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "ode/heun.hpp"
+
+#include "siqrd/runParamSearch.hpp"
+#include "siqrd/odeSys_siqrd.hpp"
+
+template <typename result_type>
+void printSummary(const std::string &observations, const result_type &result)
+{
+    std::cout << observations << ": " << result.starts.size2() << " starts, "
+              << result.no_near_best(1e-3) << " of them within 0.1% of the best LSE." << std::endl
+              << "Best LSE:        " << result.targets[result.best] << std::endl
+              << "Best parameters: " << ublas::column(result.optima, result.best) << std::endl
+              << "Mean of optima:  " << result.mean << std::endl
+              << "Std of optima:   " << result.stddev << std::endl
+              << "Min of optima:   " << result.min << std::endl
+              << "Max of optima:   " << result.max << std::endl
+              << "(parameter order alpha, beta, gamma, delta, mu)" << std::endl
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    typedef double working_precision;
+    const working_precision tol = 1e-7;
+
+    unsigned no_starts = 32, no_threads = std::max(1u, std::thread::hardware_concurrency()), candidates_per_start = 4;
+    if (!readArgument(argc, argv, 1, "number of starting guesses", 1, no_starts) ||
+        !readArgument(argc, argv, 2, "number of threads", 1, no_threads) ||
+        !readArgument(argc, argv, 3, "candidates per starting guess", 1, candidates_per_start))
+    {
+        return 1;
+    }
+#ifdef DLVL0
+    std::cout << "Starts: " << no_starts << ", threads: " << no_threads << ", candidates per start: " << candidates_per_start << std::endl;
+#endif
+
+    const std::string observations1 = "observations1",
+                      starting_guess1 = "parameters_" + observations1,
+                      observations2 = "observations2",
+                      starting_guess2 = "parameters_" + observations2,
+                      bounds = "parameter_bounds";
+
+    typedef typename ode::Heun<siqrd::OdeSys_SIQRD<working_precision>> heun;
+    auto result1 = siqrd::runMultiStart<heun>(observations1, starting_guess1, bounds, no_starts, tol,
+                                              siqrd::Optimizer::bfgs, no_threads, 0, candidates_per_start);
+    printSummary(observations1, result1);
+    auto result2 = siqrd::runMultiStart<heun>(observations2, starting_guess2, bounds, no_starts, tol,
+                                              siqrd::Optimizer::bfgs, no_threads, 0, candidates_per_start);
+    printSummary(observations2, result2);
+
+    return 0;
+}
@@ -0,0 +1,343 @@
+#ifndef ADAPTIVERK_HPP
+#define ADAPTIVERK_HPP
+/*
+    Adaptive step size driver for embedded explicit Runge-Kutta pairs (Bogacki-Shampine, Dormand-Prince).
+    Internal steps are chosen by the error estimate of the embedded solution against relative and absolute
+    tolerances and run freely over output times, states at output times are taken from dense output of the step
+    containing them (Dormand-Prince continuous extension of 4th order, cubic Hermite for other pairs).
+    As a SchemeType every time_step advances one output interval of uniform length, so OdeSolver and LSE_siqrd
+    get the solution exactly at observation days, solve_at gives it at arbitrary (irregular) times.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "butcherTableau.hpp"
+#include "../profiling/counters.hpp"
+
+namespace ode
+{
+    template <typename Tableau, typename = void>
+    struct has_dense_output : std::false_type
+    {
+    };
+
+    template <typename Tableau>
+    struct has_dense_output<Tableau, std::void_t<decltype(Tableau::dense)>> : std::true_type
+    {
+    };
+
+    // last stage is evaluated at the new solution, so it is the first stage of the next step
+    template <typename Tableau>
+    constexpr bool first_same_as_last()
+    {
+        if (Tableau::c[Tableau::stages - 1] != 1.0)
+            return false;
+        for (std::size_t j = 0; j < Tableau::stages; j++)
+        {
+            if (Tableau::a[Tableau::stages - 1][j] != Tableau::b[j])
+                return false;
+        }
+        return true;
+    }
+
+    /*
+    Satisfies concepts:
+SchemeType
+    constructor:
+        SchemeType(const value_type steps, const value_type final_time)   steps is the number of output intervals
+    member types:
+        size_type, value_type
+    member functions:
+        void time_step(const OdeSystem &system, const vector_type &old_time, vector_type &new_time)
+        void restart()                                                    forgets internal state, called by OdeSolver
+    static variables:
+        size_type dim
+        bool adaptive
+        char[] method_name
+
+    member functions:
+        void set_tolerances(value_type relative, value_type absolute)
+        bool solve_at(const OdeSystem &system, const std::vector<value_type> &times, observer_type &observer)
+
+
+    Uses concepts:
+EmbeddedTableau
+
+OdeSystem
+    member types:
+        size_type, value_type
+    member functions:
+        vector_type initial_condition() const
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+    static variables:
+        size_type dim
+*/
+
+    template <typename OdeSystem, typename Tableau>
+    class AdaptiveRK
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename OdeSystem::value_type>::value,
+                                        typename OdeSystem::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename OdeSystem::size_type>::value,
+                                        typename OdeSystem::size_type>::type size_type;
+        typedef Tableau tableau;
+
+    private:
+        static const size_type constexpr stages = Tableau::stages;
+        static_assert(Tableau::embedded_order > 0, "adaptive stepping needs an embedded pair");
+
+        value_type dT_, final_time_, rtol_, atol_;
+        // internal solution: last accepted step went from (t_prev_, y_prev_) to (t_, y_), f_ are right hand sides
+        bool valid_;
+        value_type t_, t_prev_, h_, t_end_;
+        state_type<OdeSystem> y_, y_prev_, f_, f_prev_, y_new_, stage_;
+        std::array<state_type<OdeSystem>, stages> k_;
+        // last output, a time_step continues internal solution only from it
+        value_type t_out_;
+        state_type<OdeSystem> last_out_;
+
+        // method private settings
+        static const value_type constexpr safety = 0.9;
+        static const value_type constexpr min_factor = 0.2;
+        static const value_type constexpr max_factor = 5.0;
+        static const size_type constexpr max_steps = 100000; // per output interval
+        static const size_type constexpr error_order = std::min(Tableau::order, Tableau::embedded_order) + 1;
+
+    public:
+        static constexpr const char *method_name = Tableau::adaptive_name;
+        static const size_type constexpr dim = OdeSystem::dim;
+        static const bool constexpr adaptive = true;
+
+    public:
+        AdaptiveRK()
+            : dT_(0.0), final_time_(0.0), rtol_(1e-8), atol_(1e-8), valid_(false), t_(0.0), t_prev_(0.0), h_(0.0),
+              t_end_(0.0), t_out_(0.0){};
+        AdaptiveRK(const value_type steps, const value_type final_time)
+            : dT_(final_time / steps), final_time_(final_time), rtol_(1e-8), atol_(1e-8), valid_(false), t_(0.0),
+              t_prev_(0.0), h_(0.0), t_end_(final_time), y_(dim), y_prev_(dim), f_(dim), f_prev_(dim), y_new_(dim),
+              stage_(dim), t_out_(0.0), last_out_(dim){};
+        ~AdaptiveRK(){};
+
+    public:
+        void set_tolerances(const value_type relative, const value_type absolute)
+        {
+            assert(relative > 0.0 && absolute >= 0.0);
+            rtol_ = relative;
+            atol_ = absolute;
+            valid_ = false;
+        }
+
+        void restart() { valid_ = false; }
+
+        // advances old_time by one output interval, continues the internal solution if old_time is the last output,
+        // otherwise old_time is taken as the state at time 0 (OdeSolver always starts from initial condition at 0)
+        template <typename v1, typename v2>
+        void time_step(const OdeSystem &system, const v1 &old_time, v2 &new_time)
+        {
+            assert(old_time.size() == dim);
+            assert(old_time.size() == new_time.size());
+            const bool continues = valid_ && std::equal(old_time.begin(), old_time.end(), last_out_.begin());
+            const value_type t_old = continues ? t_out_ : 0.0;
+            if (!continues)
+                start(system, old_time, 0.0, final_time_);
+            advance(system, t_old + dT_, new_time);
+        }
+
+        // observer gets (index, state) at every time of sorted times, solution starts from initial condition at times[0],
+        // returns false if observer stopped it or step size control failed (remaining states are not observed)
+        template <typename observer_type>
+        bool solve_at(const OdeSystem &system, const std::vector<value_type> &times, observer_type &observer)
+        {
+            assert(!times.empty() && std::is_sorted(times.begin(), times.end()));
+            state_type<OdeSystem> state(system.initial_condition());
+            start(system, state, times.front(), times.back());
+            for (size_type i = 0; i < times.size(); i++)
+            {
+                if (i > 0 && !advance(system, times[i], state))
+                    return false;
+                if constexpr (std::is_same<decltype(observer(i, state)), bool>::value)
+                {
+                    if (!observer(i, state))
+                        return false;
+                }
+                else
+                {
+                    observer(i, state);
+                }
+            }
+            return true;
+        }
+
+    private:
+        template <typename vector_type>
+        void start(const OdeSystem &system, const vector_type &state, const value_type t, const value_type t_end)
+        {
+            t_ = t_prev_ = t_out_ = t;
+            t_end_ = t_end;
+            y_.assign(state);
+            y_prev_.assign(state);
+            last_out_.assign(state);
+            system(y_, f_);
+            f_prev_.assign(f_);
+            h_ = initial_step(system);
+            valid_ = true;
+        }
+
+        // steps until internal solution passes t_out, interpolates state at t_out, false (and nan state) on failure
+        template <typename vector_type>
+        bool advance(const OdeSystem &system, const value_type t_out, vector_type &out)
+        {
+            size_type no_steps = 0;
+            value_type max_next = max_factor;
+            while (t_ < t_out)
+            {
+                // last step ends at final time, no work beyond it
+                const value_type h = t_ + h_ > t_end_ && t_end_ > t_ ? t_end_ - t_ : h_;
+                const value_type error = attempt(system, h);
+                if (error <= 1.0)
+                {
+                    t_prev_ = t_;
+                    t_ += h;
+                    y_prev_.swap(y_);
+                    y_.swap(y_new_);
+                    f_prev_.swap(f_);
+                    if constexpr (first_same_as_last<Tableau>())
+                        f_.assign(k_[stages - 1]);
+                    else
+                        system(y_, f_);
+                    profiling::count(profiling::Event::adaptive_step);
+                    const value_type factor = error > 0.0 ? safety * std::pow(error, -1.0 / error_order) : max_factor;
+                    // step cut short to end at final time says nothing about the step size, it can only grow
+                    const value_type cut_short = h < h_ ? h_ : 0.0;
+                    h_ = std::max(cut_short, h * std::min(max_next, std::max(min_factor, factor)));
+                    max_next = max_factor;
+                }
+                else
+                {
+                    // no growth right after a rejection, nan error (blown up trial) shrinks the step as much as allowed
+                    profiling::count(profiling::Event::rejected_step);
+                    const value_type factor = std::isfinite(error) ? safety * std::pow(error, -1.0 / error_order) : min_factor;
+                    h_ = h * std::max(min_factor, factor);
+                    max_next = 1.0;
+                }
+                // accepted step reaching t_out is interpolated whatever the next step, e.g. after a rounding sliver
+                if (t_ >= t_out)
+                    break;
+                if (++no_steps > max_steps || !(h_ > std::numeric_limits<value_type>::epsilon() * std::max(std::fabs(t_), (value_type)1.0)))
+                {
+#ifdef DMETHODS
+                    std::cout << "Adaptive step size control failed at time " << t_ << std::endl;
+#endif
+                    std::fill(out.begin(), out.end(), std::numeric_limits<value_type>::quiet_NaN());
+                    valid_ = false;
+                    return false;
+                }
+            }
+            interpolate(t_out, out);
+            t_out_ = t_out;
+            last_out_.assign(out);
+            return true;
+        }
+
+        // one step of size h from (t_, y_) into y_new_, returns norm of error estimate scaled by tolerances
+        value_type attempt(const OdeSystem &system, const value_type h)
+        {
+            k_[0].assign(f_);
+            for (size_type i = 1; i < stages; i++)
+            {
+                for (size_type r = 0; r < dim; r++)
+                {
+                    value_type sum = 0.0;
+                    for (size_type j = 0; j < i; j++)
+                    {
+                        if (Tableau::a[i][j] != 0.0)
+                            sum += Tableau::a[i][j] * k_[j][r];
+                    }
+                    stage_[r] = y_[r] + h * sum;
+                }
+                system(stage_, k_[i]);
+            }
+            value_type error = 0.0;
+            for (size_type r = 0; r < dim; r++)
+            {
+                value_type sum = 0.0, difference = 0.0;
+                for (size_type i = 0; i < stages; i++)
+                {
+                    sum += Tableau::b[i] * k_[i][r];
+                    difference += (Tableau::b[i] - Tableau::b_hat[i]) * k_[i][r];
+                }
+                y_new_[r] = y_[r] + h * sum;
+                const value_type scale = atol_ + rtol_ * std::max(std::fabs(y_[r]), std::fabs(y_new_[r]));
+                error += (h * difference / scale) * (h * difference / scale);
+            }
+            return std::sqrt(error / dim);
+        }
+
+        // dense output on [t_prev_, t_]: Hermite cubic from both ends, plus the continuous extension term
+        // h * sum d_i k_i of tableaux that define it (Hairer, Norsett, Wanner: Solving ODE I, II.6)
+        template <typename vector_type>
+        void interpolate(const value_type t, vector_type &out) const
+        {
+            const value_type h = t_ - t_prev_;
+            const value_type theta = h > 0.0 ? (t - t_prev_) / h : 1.0;
+            for (size_type r = 0; r < dim; r++)
+            {
+                const value_type delta = y_[r] - y_prev_[r];
+                const value_type c3 = h * f_prev_[r] - delta;
+                const value_type c4 = delta - h * f_[r] - c3;
+                value_type c5 = 0.0;
+                if constexpr (has_dense_output<Tableau>::value)
+                {
+                    for (size_type i = 0; i < stages; i++)
+                        c5 += Tableau::dense[i] * k_[i][r];
+                    c5 *= h;
+                }
+                out[r] = y_prev_[r] + theta * (delta + (1.0 - theta) * (c3 + theta * (c4 + (1.0 - theta) * c5)));
+            }
+        }
+
+        // Hairer's starting step: explicit Euler step of size h0 estimates second derivative
+        value_type initial_step(const OdeSystem &system)
+        {
+            value_type d0 = 0.0, d1 = 0.0, d2 = 0.0;
+            for (size_type r = 0; r < dim; r++)
+            {
+                const value_type scale = atol_ + rtol_ * std::fabs(y_[r]);
+                d0 += (y_[r] / scale) * (y_[r] / scale);
+                d1 += (f_[r] / scale) * (f_[r] / scale);
+            }
+            d0 = std::sqrt(d0 / dim);
+            d1 = std::sqrt(d1 / dim);
+            const value_type h0 = d0 < 1e-5 || d1 < 1e-5 ? 1e-6 : 0.01 * d0 / d1;
+            stage_.assign(y_ + h0 * f_);
+            system(stage_, y_new_);
+            for (size_type r = 0; r < dim; r++)
+            {
+                const value_type scale = atol_ + rtol_ * std::fabs(y_[r]);
+                d2 += ((y_new_[r] - f_[r]) / scale) * ((y_new_[r] - f_[r]) / scale);
+            }
+            d2 = std::sqrt(d2 / dim) / h0;
+            const value_type d = std::max(d1, d2);
+            const value_type h1 = d <= 1e-15 ? std::max(1e-6, h0 * 1e-3) : std::pow(0.01 / d, 1.0 / error_order);
+            return std::min(100 * h0, h1);
+        }
+    };
+
+    template <typename OdeSystem>
+    using AdaptiveBogackiShampine = AdaptiveRK<OdeSystem, bogacki_shampine_tableau>;
+    template <typename OdeSystem>
+    using AdaptiveDormandPrince = AdaptiveRK<OdeSystem, dormand_prince_tableau>;
+} // namespace ode
+#endif
@@ -0,0 +1,175 @@
+#ifndef ADJOINTSOLVER_HPP
+#define ADJOINTSOLVER_HPP
+/*
+    AdjointSolver class that solves a system of ODE until target time T with N steps, evaluates a cost
+    summed over the states and computes its gradient with respect to parameters by a discrete adjoint sweep.
+    Only every checkpoint_interval-th state is kept, states in between are recomputed during the backward sweep.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+namespace ublas = boost::numeric::ublas;
+
+namespace ode
+{
+    /*
+////Satisfies concepts:
+AdjointSolver
+    constructor:
+        AdjointSolver(const int noSteps, const value_type maxTime, const size_type checkpoint_interval)
+    member types:
+        size_type, value_type
+    member functions:
+        value_type solve(OdeSystem &ode_sys, cost_type &cost, vector_type &gradient)
+    static variables:
+        size_type dim
+
+
+////Uses concepts:
+AdjointSchemeType
+    constructor:
+        SchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type
+    member functions:
+        void time_step(const OdeSystem &ode_sys, const vector_type &old_time, vector_type &new_time)
+        void adjoint_step(const OdeSystem &system, const vector_type &old_time, const vector_type &new_time,
+                          vector_type &adjoint, vector_type &gradient)
+    static variables:
+        size_type dim
+        char[] method_name
+
+cost_type
+    member functions:
+        value_type value(size_type step, const vector_type &state)                     cost of a single state
+        void gradient(size_type step, const vector_type &state, vector_type &adjoint)  adds its derivative to adjoint
+*/
+
+    template <typename SchemeType, typename vector_type = ublas::vector<typename SchemeType::value_type>>
+    using adjoint_step_type = decltype(&SchemeType::template adjoint_step<vector_type, vector_type, vector_type, vector_type>);
+
+    // SchemeType has a discrete adjoint (is AdjointSchemeType), schemes without one do not declare adjoint_step
+    template <typename SchemeType, typename = void>
+    struct has_adjoint : std::false_type
+    {
+    };
+
+    template <typename SchemeType>
+    struct has_adjoint<SchemeType, std::void_t<adjoint_step_type<SchemeType>>> : std::true_type
+    {
+    };
+
+    template <typename SchemeType>
+    class AdjointSolver
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename SchemeType::value_type>::value,
+                                        typename SchemeType::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename SchemeType::size_type>::value,
+                                        typename SchemeType::size_type>::type size_type;
+
+    private:
+        size_type N_, interval_;
+        value_type T_;
+        SchemeType method_;
+        ublas::matrix<value_type, ublas::column_major> checkpoints_, segment_;
+        ublas::vector<value_type> adjoint_;
+
+    public:
+        static const size_type constexpr dim = SchemeType::dim;
+
+    public:
+        //default constructor
+        AdjointSolver(){};
+        //basic constructor, checkpoint_interval = 0 picks sqrt(noSteps)
+        AdjointSolver(const int noSteps, const value_type maxTime, size_type checkpoint_interval = 0)
+            : N_(noSteps), T_(maxTime), method_(N_, T_), adjoint_(dim)
+        {
+            assert(N_ > 0);
+            if (checkpoint_interval == 0)
+                checkpoint_interval = (size_type)std::ceil(std::sqrt((double)N_));
+            interval_ = std::min(checkpoint_interval, N_);
+            checkpoints_.resize(dim, (N_ + interval_ - 1) / interval_, false);
+            segment_.resize(dim, interval_ + 1, false);
+        };
+
+        // dL/dx of the initial condition, valid after solve
+        const ublas::vector<value_type> &initial_adjoint() const { return adjoint_; }
+
+        // returns cost summed over all states, gradient receives its derivative with respect to parameters
+        template <typename OdeSystem, typename cost_type, typename vector_type>
+        value_type solve(OdeSystem &ode_sys, cost_type &cost, vector_type &gradient)
+        {
+            static_assert(has_adjoint<SchemeType>::value, "AdjointSolver needs a scheme with adjoint_step");
+#ifdef DODESOLVER
+            std::cout << "Solving ODE ode_sys and its adjoint using " << SchemeType::method_name << std::endl;
+#endif
+            assert(OdeSystem::dim == dim);
+            assert(gradient.size() == OdeSystem::no_params);
+            const size_type no_segments = checkpoints_.size2();
+
+            // forward sweep, first state of every segment is a checkpoint
+            value_type cost_value = 0.0;
+            ublas::column(segment_, 0).assign(ode_sys.initial_condition());
+            cost_value += cost.value(0, ublas::column(segment_, 0));
+            for (size_type s = 0; s < no_segments; s++)
+            {
+                ublas::column(checkpoints_, s).assign(ublas::column(segment_, 0));
+                const size_type length = segment_length(s);
+                for (size_type j = 0; j < length; j++)
+                {
+                    auto old_time = ublas::column(segment_, j);
+                    auto new_time = ublas::column(segment_, j + 1);
+                    method_.time_step(ode_sys, old_time, new_time);
+                    cost_value += cost.value(s * interval_ + j + 1, new_time);
+                }
+                if (s + 1 < no_segments)
+                    ublas::column(segment_, 0).assign(ublas::column(segment_, length));
+            }
+
+            // backward sweep, segment_ still holds the last segment
+            adjoint_.clear();
+            gradient.clear();
+            for (size_type s = no_segments; s-- > 0;)
+            {
+                const size_type length = segment_length(s);
+                if (s + 1 < no_segments)
+                {
+                    ublas::column(segment_, 0).assign(ublas::column(checkpoints_, s));
+                    for (size_type j = 0; j < length; j++)
+                    {
+                        auto old_time = ublas::column(segment_, j);
+                        auto new_time = ublas::column(segment_, j + 1);
+                        method_.time_step(ode_sys, old_time, new_time);
+                    }
+                }
+                for (size_type j = length; j > 0; j--)
+                {
+                    cost.gradient(s * interval_ + j, ublas::column(segment_, j), adjoint_);
+                    method_.adjoint_step(ode_sys, ublas::column(segment_, j - 1), ublas::column(segment_, j), adjoint_, gradient);
+                }
+            }
+            cost.gradient(0, ublas::column(segment_, 0), adjoint_);
+
+#ifdef DODESOLVER
+            std::cout << "Cost: " << cost_value << std::endl
+                      << "Gradient: " << gradient << std::endl;
+#endif
+            return cost_value;
+        };
+
+    private:
+        size_type segment_length(const size_type s) const
+        {
+            return std::min(interval_, N_ - s * interval_);
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,174 @@
+#ifndef BANDEDMATRIX_HPP
+#define BANDEDMATRIX_HPP
+/*
+    Square band matrix with Lower subdiagonals and Upper superdiagonals, and its LU factorization.
+    Rows are stored as Lower + Upper + 1 contiguous values, so storage is O(dim * bandwidth) and
+    factorization without pivoting keeps fill within the band, costing O(dim * Lower * Upper).
+    Without pivoting it is meant for matrices with dominant diagonal, such as dT * J - I of implicit schemes.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+BandedMatrix
+    member functions:
+        size_type size1() const, size_type size2() const
+        value_type &operator()(size_type i, size_type j)     i - Lower <= j <= i + Upper
+        void clear()
+        BandedMatrix &operator*=(value_type factor)
+        void prod(const vector_type &x, vector_type &y) const y = A x
+    */
+    template <typename Type, std::size_t Lower, std::size_t Upper, typename SizeType = std::size_t>
+    class BandedMatrix
+    {
+    public:
+        typedef Type value_type;
+        typedef SizeType size_type;
+
+        static const size_type constexpr lower = Lower;
+        static const size_type constexpr upper = Upper;
+        static const size_type constexpr width = Lower + Upper + 1;
+
+    private:
+        size_type size_;
+        std::vector<value_type> values_; // (i, j) at i * width + j - i + Lower
+
+    public:
+        BandedMatrix() : size_(0){};
+        BandedMatrix(const size_type size1, [[maybe_unused]] const size_type size2) : size_(size1), values_(size1 * width, 0.0)
+        {
+            assert(size1 == size2);
+        };
+        ~BandedMatrix(){};
+
+    public:
+        size_type size1() const { return size_; }
+        size_type size2() const { return size_; }
+
+        const std::vector<value_type> &values() const { return values_; }
+
+        bool in_band(const size_type i, const size_type j) const { return j + Lower >= i && j <= i + Upper; }
+
+        value_type &operator()(const size_type i, const size_type j)
+        {
+            assert(i < size_ && j < size_ && in_band(i, j)); // entry outside of band
+            return values_[i * width + j + Lower - i];
+        }
+        value_type operator()(const size_type i, const size_type j) const
+        {
+            assert(i < size_ && j < size_);
+            return in_band(i, j) ? values_[i * width + j + Lower - i] : 0.0;
+        }
+
+        void clear() { std::fill(values_.begin(), values_.end(), 0.0); }
+
+        BandedMatrix &operator*=(const value_type factor)
+        {
+            for (auto &v : values_)
+                v *= factor;
+            return *this;
+        }
+
+        template <typename v1, typename v2>
+        void prod(const v1 &x, v2 &y) const
+        {
+            assert(x.size() == size_ && y.size() == size_);
+            for (size_type i = 0; i < size_; i++)
+            {
+                const size_type first = i > Lower ? i - Lower : 0, last = std::min(size_ - 1, i + Upper);
+                value_type sum = 0.0;
+                for (size_type j = first; j <= last; j++)
+                    sum += values_[i * width + j + Lower - i] * x[j];
+                y[i] = sum;
+            }
+        }
+    };
+
+    /*
+    Satisfies concepts:
+SmallLU
+    member functions:
+        void factorize(const matrix_type &matrix)
+        void solve(vector_type &rhs) const               rhs is overwritten by solution of A x = rhs
+        void solve_transposed(vector_type &rhs) const    rhs is overwritten by solution of A^T x = rhs
+    */
+    template <typename Type, std::size_t Lower, std::size_t Upper, typename SizeType = std::size_t>
+    class BandedLU
+    {
+    public:
+        typedef Type value_type;
+        typedef SizeType size_type;
+        typedef BandedMatrix<value_type, Lower, Upper, size_type> matrix_type;
+
+    private:
+        matrix_type lu_; // unit L below diagonal, U from diagonal, same band as the matrix
+
+    public:
+        BandedLU(){};
+        BandedLU(const size_type size1, const size_type size2) : lu_(size1, size2){};
+        ~BandedLU(){};
+
+    public:
+        // storage sized by constructor is reused, copy allocates only on change of size
+        void factorize(const matrix_type &matrix)
+        {
+            lu_ = matrix;
+            const size_type n = lu_.size1();
+            for (size_type i = 1; i < n; i++)
+            {
+                for (size_type k = i > Lower ? i - Lower : 0; k < i; k++)
+                {
+                    // singular matrix gives inf/nan, which callers detect on the solution
+                    const value_type l = lu_(i, k) / lu_(k, k);
+                    lu_(i, k) = l;
+                    for (size_type j = k + 1; j <= std::min(n - 1, k + Upper); j++)
+                        lu_(i, j) -= l * lu_(k, j);
+                }
+            }
+        }
+
+        template <typename vector_type>
+        void solve(vector_type &rhs) const
+        {
+            const size_type n = lu_.size1();
+            assert((size_type)rhs.size() == n);
+            for (size_type i = 1; i < n; i++)
+            {
+                for (size_type k = i > Lower ? i - Lower : 0; k < i; k++)
+                    rhs[i] -= lu_(i, k) * rhs[k];
+            }
+            for (size_type i = n; i-- > 0;)
+            {
+                for (size_type j = i + 1; j <= std::min(n - 1, i + Upper); j++)
+                    rhs[i] -= lu_(i, j) * rhs[j];
+                rhs[i] /= lu_(i, i);
+            }
+        }
+
+        // A^T = U^T L^T, U^T is lower and L^T unit upper triangular
+        template <typename vector_type>
+        void solve_transposed(vector_type &rhs) const
+        {
+            const size_type n = lu_.size1();
+            assert((size_type)rhs.size() == n);
+            for (size_type i = 0; i < n; i++)
+            {
+                rhs[i] /= lu_(i, i);
+                for (size_type j = i + 1; j <= std::min(n - 1, i + Upper); j++)
+                    rhs[j] -= lu_(i, j) * rhs[i];
+            }
+            for (size_type i = n; i-- > 1;)
+            {
+                for (size_type k = i > Lower ? i - Lower : 0; k < i; k++)
+                    rhs[k] -= lu_(i, k) * rhs[i];
+            }
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,92 @@
+#ifndef BATCHSOLVER_HPP
+#define BATCHSOLVER_HPP
+/*
+    BatchSolver class that uses batch method to solve many ODE systems (lanes) until target time T with N steps.
+    Only two states are kept, every state is handed over to an observer.
+*/
+
+#include <cassert>
+#include <iostream>
+
+namespace ode
+{
+    /*
+////Satisfies concepts:
+BatchSolver
+    constructor:
+        BatchSolver(const int noSteps, const value_type maxTime)
+    member types:
+        size_type, value_type, state_type
+    member functions:
+        void solve(const BatchOdeSystem &ode_sys, observer_type &observer)
+    static variables:
+        size_type dim
+        size_type lanes
+
+
+////Uses concepts:
+BatchSchemeType
+    constructor:
+        BatchSchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type, state_type
+    member functions:
+        void time_step(const BatchOdeSystem &system, const state_type &old_time, state_type &new_time)
+    static variables:
+        size_type dim
+        size_type lanes
+        char[] method_name
+
+observer_type
+    member functions:
+        void operator()(size_type step, const state_type &state)
+*/
+
+    template <typename BatchSchemeType>
+    class BatchSolver
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename BatchSchemeType::value_type>::value,
+                                        typename BatchSchemeType::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename BatchSchemeType::size_type>::value,
+                                        typename BatchSchemeType::size_type>::type size_type;
+        typedef typename BatchSchemeType::state_type state_type;
+
+    private:
+        size_type N_;
+        value_type T_;
+        BatchSchemeType method_;
+        state_type states_[2];
+
+    public:
+        static const size_type constexpr dim = BatchSchemeType::dim;
+        static const size_type constexpr lanes = BatchSchemeType::lanes;
+
+    public:
+        //default constructor
+        BatchSolver(){};
+        //basic constructor
+        BatchSolver(const int noSteps, const value_type maxTime)
+            : N_(noSteps), T_(maxTime), method_(N_, T_){};
+
+        // solve all lanes using method_, observer gets every state including the initial condition
+        template <typename BatchOdeSystem, typename observer_type>
+        void solve(const BatchOdeSystem &ode_sys, observer_type &observer)
+        {
+#ifdef DODESOLVER
+            std::cout << "Solving " << lanes << " ODE systems using batched " << BatchSchemeType::method_name << std::endl;
+#endif
+            ode_sys.initial_condition(states_[0]);
+            observer(0, states_[0]);
+            for (size_type step = 0; step < N_; step++)
+            {
+                // two buffers swap roles every step
+                const state_type &old_time = states_[step % 2];
+                state_type &new_time = states_[(step + 1) % 2];
+                method_.time_step(ode_sys, old_time, new_time);
+                observer(step + 1, new_time);
+            }
+        };
+    };
+} // namespace ode
+#endif
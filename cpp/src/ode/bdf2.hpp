@@ -0,0 +1,122 @@
+#ifndef BDF2_HPP
+#define BDF2_HPP
+/*
+    Second order backward differentiation formula (BDF2), L-stable two step method for stiff systems.
+    y_n+1 - 4/3 y_n + 1/3 y_n-1 = 2/3 dT f(y_n+1) is solved by NewtonSolver (see newtonSolver.hpp),
+    the first step after a restart is an Euler backward step.
+    The scheme remembers the previous state, a time_step continues the two step recursion only if old_time is
+    the last computed state, so OdeSolver runs (restart before every solve) and single steps both work.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "jacobianStructure.hpp"
+#include "newtonSolver.hpp"
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+SchemeType
+    constructor:
+        SchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type
+    member functions:
+        void time_step(const OdeSystem &system, const vector_type &old_time, vector_type &new_time)
+        void restart()                                                    forgets previous state, called by OdeSolver
+    static variables:
+        size_type dim, order
+        char[] method_name
+
+
+    Uses concepts:
+OdeSystem
+    member types:
+        size_type, value_type
+    member functions:
+        vector_type initial_condition() const
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &output_matrix )           output_matrix is newton_matrix<OdeSystem>::matrix_type,
+                                                               not used with matrix_free
+    member types:
+        jacobian_structure (optional)
+    static variables:
+        size_type dim
+*/
+
+    template <typename OdeSystem, typename NewtonType = full_newton,
+              typename Structure = typename jacobian_structure<OdeSystem>::type>
+    class BDF2
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename OdeSystem::value_type>::value,
+                                        typename OdeSystem::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename OdeSystem::size_type>::value,
+                                        typename OdeSystem::size_type>::type size_type;
+
+    private:
+        value_type dT_;
+        bool valid_;                                     // previous_ and last_ belong to the current solution
+        state_type<OdeSystem> previous_, last_, base_;  // y_n-1, last computed state y_n and constant part of equation
+        NewtonSolver<OdeSystem, NewtonType, Structure> newton_;
+
+    public:
+        static const char constexpr method_name[] = "bdf2";
+        static const size_type constexpr dim = OdeSystem::dim;
+        static const size_type constexpr order = 2;
+
+    public:
+        BDF2() : valid_(false){};
+        BDF2(const value_type steps, const value_type final_time)
+            : dT_(final_time / steps), valid_(false), previous_(dim), last_(dim), base_(dim){};
+        ~BDF2(){};
+
+    public:
+        void restart() { valid_ = false; }
+
+        template <typename v1, typename v2>
+        void time_step(const OdeSystem &system, const v1 &old_time, v2 &new_time)
+        {
+            assert((decltype(dim))old_time.size() == dim);
+            assert((decltype(new_time.size()))old_time.size() == new_time.size());
+#ifdef DMETHODS
+            std::cout << "Old time: " << old_time << std::endl;
+#endif
+            const bool continues = valid_ && std::equal(old_time.begin(), old_time.end(), last_.begin());
+            value_type residual;
+            if (continues)
+            {
+                // linear extrapolation predictor
+                base_.assign((4.0 / 3.0) * old_time - (1.0 / 3.0) * previous_);
+                new_time.assign(2.0 * old_time - previous_);
+                residual = newton_.solve(system, base_, (2.0 / 3.0) * dT_, new_time);
+            }
+            else
+            {
+                new_time.assign(old_time);
+                residual = newton_.solve(system, old_time, dT_, new_time);
+            }
+            // step without converged newton iteration is nan, as in EulerBackward
+            if (!newton_.converged(residual))
+            {
+                std::fill(new_time.begin(), new_time.end(), std::numeric_limits<value_type>::quiet_NaN());
+            }
+            previous_.assign(old_time);
+            last_.assign(new_time);
+            valid_ = true;
+#ifdef DMETHODS
+            std::cout << "New time: " << new_time << std::endl;
+#endif
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,102 @@
+#ifndef BUTCHERTABLEAU_HPP
+#define BUTCHERTABLEAU_HPP
+/*
+    Compile time Butcher tableaux of explicit Runge-Kutta methods, used by ExplicitRK.
+    Coefficients are constexpr, so every zero of a tableau is removed from the generated stage loop.
+    Embedded pairs also hold weights b_hat of the lower order solution (error estimate of adaptive stepping).
+*/
+
+#include <cstddef>
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+ButcherTableau
+    static variables:
+        std::size_t stages, order
+        double a[stages][stages]   strictly lower triangular
+        double b[stages], c[stages]
+        char[] name
+
+EmbeddedTableau (ButcherTableau with embedded solution)
+    static variables:
+        std::size_t embedded_order
+        double b_hat[stages]
+        char[] adaptive_name
+        double dense[stages]       (optional) coefficients of continuous extension, cubic Hermite without them
+    */
+
+    // classical 4th order method
+    struct rk4_tableau
+    {
+        static const std::size_t constexpr stages = 4;
+        static const std::size_t constexpr order = 4;
+        static constexpr double a[stages][stages] = {{0.0, 0.0, 0.0, 0.0},
+                                                     {0.5, 0.0, 0.0, 0.0},
+                                                     {0.0, 0.5, 0.0, 0.0},
+                                                     {0.0, 0.0, 1.0, 0.0}};
+        static constexpr double b[stages] = {1.0 / 6.0, 1.0 / 3.0, 1.0 / 3.0, 1.0 / 6.0};
+        static constexpr double c[stages] = {0.0, 0.5, 0.5, 1.0};
+        static const char constexpr name[] = "rk4";
+    };
+
+    // Bogacki-Shampine 3(2) pair, last stage is the first stage of the next step (FSAL)
+    struct bogacki_shampine_tableau
+    {
+        static const std::size_t constexpr stages = 4;
+        static const std::size_t constexpr order = 3;
+        static const std::size_t constexpr embedded_order = 2;
+        static constexpr double a[stages][stages] = {{0.0, 0.0, 0.0, 0.0},
+                                                     {1.0 / 2.0, 0.0, 0.0, 0.0},
+                                                     {0.0, 3.0 / 4.0, 0.0, 0.0},
+                                                     {2.0 / 9.0, 1.0 / 3.0, 4.0 / 9.0, 0.0}};
+        static constexpr double b[stages] = {2.0 / 9.0, 1.0 / 3.0, 4.0 / 9.0, 0.0};
+        static constexpr double b_hat[stages] = {7.0 / 24.0, 1.0 / 4.0, 1.0 / 3.0, 1.0 / 8.0};
+        static constexpr double c[stages] = {0.0, 1.0 / 2.0, 3.0 / 4.0, 1.0};
+        static const char constexpr name[] = "bs3";
+        static const char constexpr adaptive_name[] = "bs3_adaptive";
+    };
+
+    // Dormand-Prince 5(4) pair, last stage is the first stage of the next step (FSAL)
+    struct dormand_prince_tableau
+    {
+        static const std::size_t constexpr stages = 7;
+        static const std::size_t constexpr order = 5;
+        static const std::size_t constexpr embedded_order = 4;
+        static constexpr double a[stages][stages] = {
+            {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+            {1.0 / 5.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+            {3.0 / 40.0, 9.0 / 40.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+            {44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0, 0.0, 0.0, 0.0, 0.0},
+            {19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0, 0.0, 0.0, 0.0},
+            {9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0, 0.0, 0.0},
+            {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0, 0.0}};
+        static constexpr double b[stages] = {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0,
+                                             -2187.0 / 6784.0, 11.0 / 84.0, 0.0};
+        static constexpr double b_hat[stages] = {5179.0 / 57600.0, 0.0, 7571.0 / 16695.0, 393.0 / 640.0,
+                                                 -92097.0 / 339200.0, 187.0 / 2100.0, 1.0 / 40.0};
+        static constexpr double c[stages] = {0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0};
+        // 4th order continuous extension (Hairer, Norsett, Wanner: Solving ODE I, II.6)
+        static constexpr double dense[stages] = {-12715105075.0 / 11282082432.0, 0.0, 87487479700.0 / 32700410799.0,
+                                                 -10690763975.0 / 1880347072.0, 701980252875.0 / 199316789632.0,
+                                                 -1453857185.0 / 822651844.0, 69997945.0 / 29380423.0};
+        static const char constexpr name[] = "dopri5";
+        static const char constexpr adaptive_name[] = "dopri5_adaptive";
+    };
+
+    // stage i contributes to the solution or to a later used stage, unused ones (e.g. FSAL stage with fixed steps) are skipped
+    template <typename Tableau>
+    constexpr bool stage_used(const std::size_t i)
+    {
+        if (Tableau::b[i] != 0.0)
+            return true;
+        for (std::size_t j = i + 1; j < Tableau::stages; j++)
+        {
+            if (Tableau::a[j][i] != 0.0 && stage_used<Tableau>(j))
+                return true;
+        }
+        return false;
+    }
+} // namespace ode
+#endif
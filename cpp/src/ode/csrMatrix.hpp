@@ -0,0 +1,124 @@
+#ifndef CSRMATRIX_HPP
+#define CSRMATRIX_HPP
+/*
+    Square sparse matrix in compressed sparse row format with a fixed pattern.
+    Pattern is set once (column indices sorted within each row), afterwards only values change,
+    so jacobians of large systems are stored and scaled without any dim x dim storage.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+CsrMatrix
+    member functions:
+        size_type size1() const, size_type size2() const, size_type nnz() const
+        void set_pattern(size_type n, const std::vector<std::vector<size_type>> &rows)
+        value_type &operator()(size_type i, size_type j)     (i, j) has to be in pattern
+        void clear()                                          zeroes values, keeps pattern
+        CsrMatrix &operator*=(value_type factor)
+        void prod(const vector_type &x, vector_type &y) const y = A x
+    */
+    template <typename Type, typename SizeType = std::size_t>
+    class CsrMatrix
+    {
+    public:
+        typedef Type value_type;
+        typedef SizeType size_type;
+
+    private:
+        size_type size_;
+        std::vector<size_type> row_start_, columns_;
+        std::vector<value_type> values_;
+
+    public:
+        CsrMatrix() : size_(0), row_start_(1, 0){};
+        // empty pattern, set_pattern has to be called before use
+        CsrMatrix(const size_type size1, [[maybe_unused]] const size_type size2) : size_(size1), row_start_(size1 + 1, 0)
+        {
+            assert(size1 == size2);
+        };
+        ~CsrMatrix(){};
+
+    public:
+        size_type size1() const { return size_; }
+        size_type size2() const { return size_; }
+        size_type nnz() const { return columns_.size(); }
+
+        const std::vector<size_type> &row_start() const { return row_start_; }
+        const std::vector<size_type> &columns() const { return columns_; }
+        const std::vector<value_type> &values() const { return values_; }
+        std::vector<value_type> &values() { return values_; }
+
+        // rows[i] holds column indices of row i, values are zero afterwards
+        void set_pattern(const size_type n, const std::vector<std::vector<size_type>> &rows)
+        {
+            assert(rows.size() == n);
+            size_ = n;
+            row_start_.assign(n + 1, 0);
+            columns_.clear();
+            for (size_type i = 0; i < n; i++)
+            {
+                assert(std::is_sorted(rows[i].begin(), rows[i].end()));
+                columns_.insert(columns_.end(), rows[i].begin(), rows[i].end());
+                row_start_[i + 1] = columns_.size();
+            }
+            values_.assign(columns_.size(), 0.0);
+        }
+
+        // pattern is the one set_pattern(n, rows) would set
+        bool has_pattern(const std::vector<std::vector<size_type>> &rows) const
+        {
+            if (rows.size() != size_ || row_start_.size() != size_ + 1)
+                return false;
+            for (size_type i = 0; i < size_; i++)
+            {
+                if (row_start_[i + 1] - row_start_[i] != rows[i].size() ||
+                    !std::equal(rows[i].begin(), rows[i].end(), columns_.begin() + row_start_[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        // position of (i, j) in values(), binary search within row i
+        size_type position(const size_type i, const size_type j) const
+        {
+            assert(i < size_ && j < size_);
+            const auto begin = columns_.begin() + row_start_[i], end = columns_.begin() + row_start_[i + 1];
+            const auto it = std::lower_bound(begin, end, j);
+            assert(it != end && *it == j); // entry outside of pattern
+            return it - columns_.begin();
+        }
+
+        value_type &operator()(const size_type i, const size_type j) { return values_[position(i, j)]; }
+        value_type operator()(const size_type i, const size_type j) const { return values_[position(i, j)]; }
+
+        void clear() { std::fill(values_.begin(), values_.end(), 0.0); }
+
+        CsrMatrix &operator*=(const value_type factor)
+        {
+            for (auto &v : values_)
+                v *= factor;
+            return *this;
+        }
+
+        template <typename v1, typename v2>
+        void prod(const v1 &x, v2 &y) const
+        {
+            assert(x.size() == size_ && y.size() == size_);
+            for (size_type i = 0; i < size_; i++)
+            {
+                value_type sum = 0.0;
+                for (size_type p = row_start_[i]; p < row_start_[i + 1]; p++)
+                    sum += values_[p] * x[columns_[p]];
+                y[i] = sum;
+            }
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,118 @@
+#ifndef DIAGONALMATRIX_HPP
+#define DIAGONALMATRIX_HPP
+/*
+    Square diagonal matrix and its trivial factorization.
+    Jacobians of decoupled systems (such as OdeSys_test) are stored in dim values, iteration matrix
+    of implicit schemes is "factorized" by a copy and solved by elementwise division.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+DiagonalMatrix
+    member functions:
+        size_type size1() const, size_type size2() const
+        value_type &operator()(size_type i, size_type j)     i == j
+        void clear()
+        DiagonalMatrix &operator*=(value_type factor)
+        void prod(const vector_type &x, vector_type &y) const y = A x
+    */
+    template <typename Type, typename SizeType = std::size_t>
+    class DiagonalMatrix
+    {
+    public:
+        typedef Type value_type;
+        typedef SizeType size_type;
+
+    private:
+        std::vector<value_type> values_;
+
+    public:
+        DiagonalMatrix(){};
+        DiagonalMatrix(const size_type size1, [[maybe_unused]] const size_type size2) : values_(size1, 0.0)
+        {
+            assert(size1 == size2);
+        };
+        ~DiagonalMatrix(){};
+
+    public:
+        size_type size1() const { return values_.size(); }
+        size_type size2() const { return values_.size(); }
+
+        const std::vector<value_type> &values() const { return values_; }
+
+        value_type &operator()(const size_type i, [[maybe_unused]] const size_type j)
+        {
+            assert(i == j && i < values_.size()); // entry outside of diagonal
+            return values_[i];
+        }
+        value_type operator()(const size_type i, const size_type j) const { return i == j ? values_[i] : 0.0; }
+
+        void clear() { std::fill(values_.begin(), values_.end(), 0.0); }
+
+        DiagonalMatrix &operator*=(const value_type factor)
+        {
+            for (auto &v : values_)
+                v *= factor;
+            return *this;
+        }
+
+        template <typename v1, typename v2>
+        void prod(const v1 &x, v2 &y) const
+        {
+            assert(x.size() == values_.size() && y.size() == values_.size());
+            for (size_type i = 0; i < values_.size(); i++)
+                y[i] = values_[i] * x[i];
+        }
+    };
+
+    /*
+    Satisfies concepts:
+SmallLU
+    member functions:
+        void factorize(const matrix_type &matrix)
+        void solve(vector_type &rhs) const               rhs is overwritten by solution of A x = rhs
+        void solve_transposed(vector_type &rhs) const    rhs is overwritten by solution of A^T x = rhs
+    */
+    template <typename Type, typename SizeType = std::size_t>
+    class DiagonalLU
+    {
+    public:
+        typedef Type value_type;
+        typedef SizeType size_type;
+
+    private:
+        std::vector<value_type> diagonal_;
+
+    public:
+        DiagonalLU(){};
+        DiagonalLU(const size_type size1, [[maybe_unused]] const size_type size2) : diagonal_(size1, 0.0)
+        {
+            assert(size1 == size2);
+        };
+        ~DiagonalLU(){};
+
+    public:
+        // storage sized by constructor is reused, copy allocates only on change of size
+        void factorize(const DiagonalMatrix<value_type, size_type> &matrix) { diagonal_ = matrix.values(); }
+
+        // zero on diagonal gives inf/nan, which callers detect on the solution
+        template <typename vector_type>
+        void solve(vector_type &rhs) const
+        {
+            assert((size_type)rhs.size() == diagonal_.size());
+            for (size_type i = 0; i < diagonal_.size(); i++)
+                rhs[i] /= diagonal_[i];
+        }
+
+        template <typename vector_type>
+        void solve_transposed(vector_type &rhs) const { solve(rhs); }
+    };
+} // namespace ode
+#endif
@@ -2,17 +2,29 @@
 #define EULERBACKWARD_HPP
 /*
     Euler backward method for solving ODE system.
+    Implicit equation is solved by full Newton method, or by simplified Newton method reusing the factorized
+    iteration matrix over iterations and steps until convergence slows down (see newtonSolver.hpp).
+    Iteration matrix is dense, diagonal, banded or sparse as declared by OdeSystem (see jacobianStructure.hpp),
+    with matrix_free structure Newton corrections come from GMRES on finite differences of the right hand side
+    (Jacobian-free Newton-Krylov) and OdeSystem::jacobian is not needed.
 */
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <type_traits>
 
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
-#include <boost/numeric/ublas/lu.hpp>
 namespace ublas = boost::numeric::ublas;
 
+#include "stateType.hpp"
+#include "jacobianStructure.hpp"
+#include "newtonSolver.hpp"
+
 namespace ode
 {
     /*
@@ -25,9 +37,14 @@ SchemeType
     member functions:
         void time_step(const OdeSystem &system, const vector_type &old_time, vector_type &new_time)
     static variables:
-        size_type dim
+        size_type dim, order
         char[] method_name
 
+AdjointSchemeType (SchemeType with discrete adjoint)
+    member functions:
+        void adjoint_step(const OdeSystem &system, const vector_type &old_time, const vector_type &new_time,
+                          vector_type &adjoint, vector_type &gradient)
+
 
     Uses concepts:
 OdeSystem 
@@ -37,12 +54,19 @@ OdeSystem
         vector_type initial_condition() const
         vector_type operator()( vector_type )
         void operator()(const v1 &variables_vector, v2 &return_vector)
-        void jacobian()( variables, &output_matrix )
+        void jacobian()( variables, &output_matrix )           output_matrix is newton_matrix<OdeSystem>::matrix_type,
+                                                               not used with matrix_free
+        void parameter_jacobian()( variables, &output_matrix ) (adjoint_step only, not with matrix_free)
+    member types:
+        jacobian_structure (optional, dense_jacobian, diagonal_jacobian, banded_jacobian, sparse_jacobian or matrix_free)
     static variables:
         size_type dim
+        size_type no_params (adjoint_step only)
 */
 
-    template <typename OdeSystem>
+    // Structure overrides the one declared by OdeSystem, e.g. matrix_free for a system with expensive jacobian
+    template <typename OdeSystem, typename NewtonType = full_newton,
+              typename Structure = typename jacobian_structure<OdeSystem>::type>
     class EulerBackward
     {
     public:
@@ -53,22 +77,18 @@ OdeSystem
 
     private:
         value_type dT_;
-        ublas::vector<value_type> temp_;
-        ublas::matrix<value_type> jac_;
-        ublas::permutation_matrix<int> pm_, pm_default;
-
-        // method private settings
-        static const value_type constexpr tolerance = std::numeric_limits<value_type>::epsilon() * 100.0;
-        static const size_type constexpr max_iter = 1000;
+        state_type<OdeSystem> temp_, rhs_;
+        NewtonSolver<OdeSystem, NewtonType, Structure> newton_;
 
     public:
         static const char constexpr method_name[] = "bwe";
-        static const value_type constexpr dim = OdeSystem::dim;
+        static const size_type constexpr dim = OdeSystem::dim;
+        static const size_type constexpr order = 1;
 
     public:
-        EulerBackward() : pm_(0), pm_default(0){};
+        EulerBackward(){};
         EulerBackward(const value_type steps, const value_type final_time)
-            : dT_(final_time / steps), temp_(dim), jac_(dim, dim), pm_(dim), pm_default(dim){};
+            : dT_(final_time / steps), temp_(dim), rhs_(dim){};
         ~EulerBackward(){};
 
     public:
@@ -77,70 +97,40 @@ OdeSystem
         {
             assert((decltype(dim))old_time.size() == dim);
             assert((decltype(new_time.size()))old_time.size() == new_time.size());
-            value_type res = std::numeric_limits<value_type>::infinity();
-            value_type norm = ublas::norm_1(old_time);
 #ifdef DMETHODS
             std::cout << "Old time: " << old_time << std::endl;
-            std::cout << "Normalizer: " << norm << std::endl;
-            bool converged = false;
 #endif
-            new_time.assign(old_time);
-            size_type i;
-            for (i = 0; i < max_iter; i++)
+            // newton starts from explicit euler predictor
+            system(old_time, rhs_);
+            new_time.assign(old_time + dT_ * rhs_);
+            // step without converged newton iteration is nan, as if it blew up, so LSE rejects the parameters
+            if (!newton_.converged(newton_.solve(system, old_time, dT_, new_time)))
             {
-                // check convergence
-                temp_.assign((old_time - new_time) + dT_ * system(new_time));
-                res = ublas::norm_inf(temp_) / norm;
-                if (res < tolerance)
-                {
-                    #ifdef DMETHODS
-                        bool converged = true;
-                    #endif
-                    break;
-                }
-
-                // jacobian matrix
-                jacG(new_time, jac_, system);
-
-                // compute inversion
-                pm_.assign(pm_default);
-                ublas::lu_factorize(jac_, pm_);
-                ublas::lu_substitute(jac_, pm_, temp_);
-
-                // new iteration
-                new_time.assign(new_time - temp_);
+                std::fill(new_time.begin(), new_time.end(), std::numeric_limits<value_type>::quiet_NaN());
             }
-
-#ifdef DMETHODS
-            if (converged)
-            {
-
-                std::cout << "Euler backward converged in " << i + 1 << " steps." << std::endl
-                          << std::endl;
-            }
-            else
-            {
-                std::cout << "Euler backward did not converge! " << std::endl;
-                std::exit(1);
-            }
-#endif
-
 #ifdef DMETHODS
             std::cout << "New time: " << new_time << std::endl;
-            std::cout << "Residual: " << res << std::endl;
 #endif
         }
 
-    private:
-        template <typename vector, typename matrix_type>
-        inline void jacG(const vector &vars, matrix_type &matrix, const OdeSystem &system) const
+        // adjoint holds dL/dx of new_time on input and dL/dx of old_time on output, dL/dp is added to gradient
+        template <typename v1, typename v2, typename v3, typename v4>
+        void adjoint_step(const OdeSystem &system, const v1 &, const v2 &new_time, v3 &adjoint, v4 &gradient)
         {
-            system.jacobian(vars, matrix);
-            matrix *= dT_;
-            for (size_t i = 0; i < matrix.size1(); i++)
-            {
-                matrix(i, i) -= 1.0;
-            }
+            assert(new_time.size() == dim);
+            assert(adjoint.size() == dim);
+            assert(gradient.size() == OdeSystem::no_params);
+            static_assert(!std::is_same<Structure, matrix_free>::value, "discrete adjoint needs jacobian of OdeSystem");
+            small_matrix<value_type, dim, OdeSystem::no_params> param_jac;
+
+            // solve (I - dT*J)^T nu = adjoint, newton_ factorizes (dT*J - I)
+            newton_.factorize(system, new_time, dT_, false);
+            temp_.assign(-adjoint);
+            newton_.lu().solve_transposed(temp_);
+            adjoint.assign(temp_);
+
+            system.parameter_jacobian(new_time, param_jac);
+            noalias(gradient) += dT_ * ublas::prod(ublas::trans(param_jac), adjoint);
         }
     };
 } // namespace ode
@@ -7,6 +7,12 @@
 #include <cassert>
 #include <iostream>
 
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+
 namespace ode
 {
 /*
@@ -22,6 +28,11 @@ SchemeType
         size_type dim
         char[] method_name
 
+AdjointSchemeType (SchemeType with discrete adjoint)
+    member functions:
+        void adjoint_step(const OdeSystem &system, const vector_type &old_time, const vector_type &new_time,
+                          vector_type &adjoint, vector_type &gradient)
+
 
     Uses concepts:
 OdeSystem 
@@ -32,8 +43,10 @@ OdeSystem
         vector_type operator()( vector_type )
         void operator()(const v1 &variables_vector, v2 &return_vector)
         void jacobian()( variables, &output_matrix )
+        void parameter_jacobian()( variables, &output_matrix ) (adjoint_step only)
     static variables:
         size_type dim
+        size_type no_params (adjoint_step only)
 */
 
     template <typename OdeSystem>
@@ -47,6 +60,7 @@ OdeSystem
 
     private:
         value_type dT_;
+        state_type<OdeSystem> rhs_;
 
     public:
         static const char constexpr method_name[] = "fwe";
@@ -55,12 +69,12 @@ OdeSystem
     public:
         EulerForward(){};
         EulerForward(const size_type steps, const value_type final_time)
-            : dT_(final_time / steps){};
+            : dT_(final_time / steps), rhs_(dim){};
         ~EulerForward(){};
 
     public:
         template <typename v1, typename v2>
-        inline void time_step(const OdeSystem &system, const v1 &old_time, v2 &new_time) const
+        inline void time_step(const OdeSystem &system, const v1 &old_time, v2 &new_time)
         {
             assert(old_time.size() == dim);
             assert(old_time.size() == new_time.size());
@@ -68,12 +82,32 @@ OdeSystem
             std::cout << "Old time: " << old_time << std::endl;
             #endif
 
-            new_time.assign(old_time + dT_ * system(old_time));
+            system(old_time, rhs_);
+            new_time.assign(old_time + dT_ * rhs_);
             
             #ifdef DMETHODS
             std::cout << "New time: " << new_time << std::endl;
             #endif
         }
+
+        // adjoint holds dL/dx of new_time on input and dL/dx of old_time on output, dL/dp is added to gradient
+        template <typename v1, typename v2, typename v3, typename v4>
+        void adjoint_step(const OdeSystem &system, const v1 &old_time, const v2 &, v3 &adjoint, v4 &gradient) const
+        {
+            assert(old_time.size() == dim);
+            assert(adjoint.size() == dim);
+            assert(gradient.size() == OdeSystem::no_params);
+            jacobian_type<OdeSystem> jac;
+            small_matrix<value_type, dim, OdeSystem::no_params> param_jac;
+
+            state_type<OdeSystem> increment;
+
+            system.jacobian(old_time, jac);
+            system.parameter_jacobian(old_time, param_jac);
+            noalias(gradient) += dT_ * ublas::prod(ublas::trans(param_jac), adjoint);
+            increment.assign(dT_ * ublas::prod(ublas::trans(jac), adjoint));
+            noalias(adjoint) += increment;
+        }
     };
 } // namespace ode
 #endif
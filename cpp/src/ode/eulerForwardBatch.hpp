@@ -0,0 +1,82 @@
+#ifndef EULERFORWARDBATCH_HPP
+#define EULERFORWARDBATCH_HPP
+/*
+    Euler forward method advancing a batch of ODE systems (one per lane) at once.
+*/
+
+#include <cassert>
+#include <iostream>
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+BatchSchemeType
+    constructor:
+        BatchSchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type, state_type, system_type
+    member functions:
+        void time_step(const BatchOdeSystem &system, const state_type &old_time, state_type &new_time)
+    static variables:
+        size_type dim
+        size_type lanes
+        char[] method_name
+
+
+    Uses concepts:
+BatchOdeSystem
+    member types:
+        size_type, value_type, state_type (dim x lanes, row major)
+    member functions:
+        void initial_condition(state_type &state) const
+        void operator()(const state_type &variables, state_type &return_state)
+    static variables:
+        size_type dim
+        size_type lanes
+*/
+
+    template <typename BatchOdeSystem>
+    class EulerForwardBatch
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename BatchOdeSystem::value_type>::value,
+                                        typename BatchOdeSystem::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename BatchOdeSystem::size_type>::value,
+                                        typename BatchOdeSystem::size_type>::type size_type;
+        typedef typename BatchOdeSystem::state_type state_type;
+        typedef BatchOdeSystem system_type;
+
+    private:
+        value_type dT_;
+        state_type rhs_;
+
+    public:
+        static const char constexpr method_name[] = "fwe";
+        static const size_type constexpr dim = BatchOdeSystem::dim;
+        static const size_type constexpr lanes = BatchOdeSystem::lanes;
+
+    public:
+        EulerForwardBatch(){};
+        EulerForwardBatch(const size_type steps, const value_type final_time)
+            : dT_(final_time / steps){};
+        ~EulerForwardBatch(){};
+
+    public:
+        inline void time_step(const BatchOdeSystem &system, const state_type &old_time, state_type &new_time)
+        {
+            system(old_time, rhs_);
+
+            const value_type *x = &old_time(0, 0), *f = &rhs_(0, 0);
+            value_type *x_new = &new_time(0, 0);
+            for (size_type i = 0; i < dim * lanes; i++)
+            {
+                x_new[i] = x[i] + dT_ * f[i];
+            }
+#ifdef DMETHODS
+            std::cout << "New time: " << new_time << std::endl;
+#endif
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,192 @@
+#ifndef EXPLICITRK_HPP
+#define EXPLICITRK_HPP
+/*
+    Explicit Runge-Kutta method given by a compile time Butcher tableau (see butcherTableau.hpp).
+    Stages live in fixed size vectors inside the scheme, a time step allocates nothing.
+*/
+
+#include <array>
+#include <cassert>
+#include <iostream>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "butcherTableau.hpp"
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+SchemeType
+    constructor:
+        SchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type
+    member functions:
+        void time_step(const OdeSystem &system, const vector_type &old_time, vector_type &new_time)
+    static variables:
+        size_type dim, order
+        char[] method_name
+
+AdjointSchemeType (SchemeType with discrete adjoint)
+    member functions:
+        void adjoint_step(const OdeSystem &system, const vector_type &old_time, const vector_type &new_time,
+                          vector_type &adjoint, vector_type &gradient)
+
+
+    Uses concepts:
+ButcherTableau
+
+OdeSystem
+    member types:
+        size_type, value_type
+    member functions:
+        vector_type initial_condition() const
+        vector_type operator()( vector_type )
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &output_matrix )           (adjoint_step only)
+        void parameter_jacobian()( variables, &output_matrix ) (adjoint_step only)
+    static variables:
+        size_type dim
+        size_type no_params (adjoint_step only)
+*/
+
+    template <typename OdeSystem, typename Tableau>
+    class ExplicitRK
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename OdeSystem::value_type>::value,
+                                        typename OdeSystem::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename OdeSystem::size_type>::value,
+                                        typename OdeSystem::size_type>::type size_type;
+        typedef Tableau tableau;
+
+    private:
+        static const size_type constexpr stages = Tableau::stages;
+
+        value_type dT_;
+        std::array<state_type<OdeSystem>, stages> k_; // right hand side at every stage
+        state_type<OdeSystem> stage_;
+
+    public:
+        static constexpr const char *method_name = Tableau::name;
+        static const size_type constexpr dim = OdeSystem::dim;
+        static const size_type constexpr order = Tableau::order;
+
+    public:
+        ExplicitRK(){};
+        ExplicitRK(const value_type steps, const value_type final_time)
+            : dT_(final_time / (value_type)steps), stage_(dim){};
+        ~ExplicitRK(){};
+
+    public:
+        template <typename v1, typename v2>
+        inline void time_step(const OdeSystem &system, const v1 &old_time, v2 &new_time)
+        {
+            assert(old_time.size() == dim);
+            assert(old_time.size() == new_time.size());
+#ifdef DMETHODS
+            std::cout << "Old time: " << old_time << std::endl;
+#endif
+
+            for (size_type i = 0; i < stages; i++)
+            {
+                if (!stage_used<Tableau>(i))
+                    continue;
+                if (i == 0)
+                {
+                    system(old_time, k_[0]);
+                    continue;
+                }
+                stage_input(old_time, i);
+                system(stage_, k_[i]);
+            }
+            for (size_type r = 0; r < dim; r++)
+            {
+                value_type sum = 0.0;
+                for (size_type i = 0; i < stages; i++)
+                {
+                    if (Tableau::b[i] != 0.0)
+                        sum += Tableau::b[i] * k_[i][r];
+                }
+                new_time[r] = old_time[r] + dT_ * sum;
+            }
+
+#ifdef DMETHODS
+            std::cout << "New time: " << new_time << std::endl;
+#endif
+        }
+
+        // adjoint holds dL/dx of new_time on input and dL/dx of old_time on output, dL/dp is added to gradient,
+        // stages are recomputed and swept backward: kappa_i = dT (b_i adjoint + sum_j>i a_ji theta_j), theta_i = J_i^T kappa_i
+        template <typename v1, typename v2, typename v3, typename v4>
+        void adjoint_step(const OdeSystem &system, const v1 &old_time, const v2 &, v3 &adjoint, v4 &gradient)
+        {
+            assert(old_time.size() == dim);
+            assert(adjoint.size() == dim);
+            assert(gradient.size() == OdeSystem::no_params);
+            jacobian_type<OdeSystem> jac;
+            small_matrix<value_type, dim, OdeSystem::no_params> param_jac;
+            std::array<state_type<OdeSystem>, stages> inputs, theta;
+            state_type<OdeSystem> kappa;
+
+            for (size_type i = 0; i < stages; i++)
+            {
+                if (!stage_used<Tableau>(i))
+                    continue;
+                stage_input(old_time, i);
+                inputs[i].assign(stage_);
+                system(stage_, k_[i]);
+            }
+
+            for (size_type i = stages; i-- > 0;)
+            {
+                if (!stage_used<Tableau>(i))
+                    continue;
+                kappa.assign((dT_ * Tableau::b[i]) * adjoint);
+                for (size_type j = i + 1; j < stages; j++)
+                {
+                    if (Tableau::a[j][i] != 0.0 && stage_used<Tableau>(j))
+                        noalias(kappa) += (dT_ * Tableau::a[j][i]) * theta[j];
+                }
+                system.jacobian(inputs[i], jac);
+                system.parameter_jacobian(inputs[i], param_jac);
+                theta[i].assign(ublas::prod(ublas::trans(jac), kappa));
+                noalias(gradient) += ublas::prod(ublas::trans(param_jac), kappa);
+            }
+            for (size_type i = 0; i < stages; i++)
+            {
+                if (stage_used<Tableau>(i))
+                    noalias(adjoint) += theta[i];
+            }
+        }
+
+    private:
+        // stage_ = old_time + dT * sum_j<i a_ij k_j
+        template <typename vector_type>
+        inline void stage_input(const vector_type &old_time, const size_type i)
+        {
+            for (size_type r = 0; r < dim; r++)
+            {
+                value_type sum = 0.0;
+                for (size_type j = 0; j < i; j++)
+                {
+                    if (Tableau::a[i][j] != 0.0)
+                        sum += Tableau::a[i][j] * k_[j][r];
+                }
+                stage_[r] = old_time[r] + dT_ * sum;
+            }
+        }
+    };
+
+    template <typename OdeSystem>
+    using RK4 = ExplicitRK<OdeSystem, rk4_tableau>;
+    template <typename OdeSystem>
+    using BogackiShampine = ExplicitRK<OdeSystem, bogacki_shampine_tableau>;
+    template <typename OdeSystem>
+    using DormandPrince = ExplicitRK<OdeSystem, dormand_prince_tableau>;
+} // namespace ode
+#endif
@@ -0,0 +1,134 @@
+#ifndef GMRES_HPP
+#define GMRES_HPP
+/*
+    Restarted GMRES for A x = b, where A is only available as a product with a vector.
+    Used by implicit schemes with matrix_free jacobian structure, A v is then a finite difference of
+    the right hand side, so neither jacobian nor any dim x dim matrix is ever formed.
+    Krylov basis of Restart + 1 vectors is allocated once, modified Gram-Schmidt with Givens rotations.
+*/
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "../profiling/counters.hpp"
+
+namespace ode
+{
+    /*
+    Uses concepts:
+Operator
+    member functions:
+        void operator()(const vector_type &v, vector_type &result) const     result = A v
+    */
+    template <typename Type, std::size_t Dim, std::size_t Restart = 30>
+    class Gmres
+    {
+    public:
+        typedef Type value_type;
+        typedef std::size_t size_type;
+        typedef small_vector<value_type, Dim> vector_type;
+
+    private:
+        std::vector<vector_type> basis_;
+        vector_type w_, x_;
+        std::array<std::array<value_type, Restart>, Restart + 1> hessenberg_;
+        std::array<value_type, Restart + 1> g_;
+        std::array<value_type, Restart> cs_, sn_;
+
+    public:
+        Gmres() : basis_(Restart + 1, vector_type(Dim)), w_(Dim), x_(Dim){};
+        ~Gmres(){};
+
+    public:
+        // rhs is overwritten by solution (initial guess zero) with ||b - A x|| <= tolerance * ||b||,
+        // returns number of products with A, stops after max_iter of them
+        template <typename Operator, typename vector>
+        size_type solve(const Operator &apply, vector &rhs, const value_type tolerance, const size_type max_iter)
+        {
+            assert(rhs.size() == Dim);
+            const value_type norm_b = ublas::norm_2(rhs);
+            x_.clear();
+            size_type iter = 0;
+            bool converged = !(norm_b > 0.0);
+            while (!converged && iter < max_iter)
+            {
+                // residual of current x_ starts the cycle, A x_ is skipped in the first one
+                if (iter == 0)
+                {
+                    basis_[0].assign(rhs);
+                }
+                else
+                {
+                    apply(x_, w_);
+                    basis_[0].assign(rhs - w_);
+                }
+                const value_type beta = ublas::norm_2(basis_[0]);
+                if (!(beta > tolerance * norm_b))
+                    break;
+                basis_[0] /= beta;
+                g_.fill(0.0);
+                g_[0] = beta;
+
+                size_type k = 0;
+                while (k < Restart && iter < max_iter)
+                {
+                    apply(basis_[k], w_);
+                    profiling::count(profiling::Event::krylov_iteration);
+                    iter++;
+                    for (size_type i = 0; i <= k; i++)
+                    {
+                        hessenberg_[i][k] = ublas::inner_prod(w_, basis_[i]);
+                        w_ -= hessenberg_[i][k] * basis_[i];
+                    }
+                    const value_type h = ublas::norm_2(w_);
+                    hessenberg_[k + 1][k] = h;
+                    if (h > 0.0)
+                        basis_[k + 1].assign(w_ / h);
+
+                    // previous rotations on the new column, then the one eliminating its subdiagonal
+                    for (size_type i = 0; i < k; i++)
+                    {
+                        const value_type a = hessenberg_[i][k], b = hessenberg_[i + 1][k];
+                        hessenberg_[i][k] = cs_[i] * a + sn_[i] * b;
+                        hessenberg_[i + 1][k] = -sn_[i] * a + cs_[i] * b;
+                    }
+                    const value_type r = std::hypot(hessenberg_[k][k], h);
+                    cs_[k] = hessenberg_[k][k] / r;
+                    sn_[k] = h / r;
+                    hessenberg_[k][k] = r;
+                    hessenberg_[k + 1][k] = 0.0;
+                    g_[k + 1] = -sn_[k] * g_[k];
+                    g_[k] = cs_[k] * g_[k];
+                    k++;
+
+                    // |g_[k]| is the residual norm, zero h means the Krylov space contains the solution
+                    if (std::fabs(g_[k]) <= tolerance * norm_b || !(h > 0.0))
+                    {
+                        converged = true;
+                        break;
+                    }
+                }
+
+                // back substitution of the k x k triangle, x_ += V y
+                for (size_type i = k; i-- > 0;)
+                {
+                    for (size_type j = i + 1; j < k; j++)
+                        g_[i] -= hessenberg_[i][j] * g_[j];
+                    g_[i] /= hessenberg_[i][i];
+                }
+                for (size_type i = 0; i < k; i++)
+                    x_ += g_[i] * basis_[i];
+            }
+            rhs.assign(x_);
+            return iter;
+        }
+    };
+} // namespace ode
+#endif
@@ -8,8 +8,11 @@
 #include <iostream>
 
 #include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
 namespace ublas = boost::numeric::ublas;
 
+#include "stateType.hpp"
+
 namespace ode
 {
     /*
@@ -25,6 +28,11 @@ SchemeType
         size_type dim
         char[] method_name
 
+AdjointSchemeType (SchemeType with discrete adjoint)
+    member functions:
+        void adjoint_step(const OdeSystem &system, const vector_type &old_time, const vector_type &new_time,
+                          vector_type &adjoint, vector_type &gradient)
+
 
     Uses concepts:
 OdeSystem 
@@ -35,8 +43,10 @@ OdeSystem
         vector_type operator()( vector_type )
         void operator()(const v1 &variables_vector, v2 &return_vector)
         void jacobian()( variables, &output_matrix )
+        void parameter_jacobian()( variables, &output_matrix ) (adjoint_step only)
     static variables:
         size_type dim
+        size_type no_params (adjoint_step only)
 */
 
     template <typename OdeSystem>
@@ -50,7 +60,7 @@ OdeSystem
 
     private:
         value_type dT_;
-        ublas::vector<value_type> temp_;
+        state_type<OdeSystem> temp_, rhs_, stage_;
 
     public:
         static const char constexpr method_name[] = "heun";
@@ -59,7 +69,7 @@ OdeSystem
     public:
         Heun(){};
         Heun(const size_type steps, const value_type final_time)
-            : dT_(final_time / (value_type)steps), temp_(dim){};
+            : dT_(final_time / (value_type)steps), temp_(dim), rhs_(dim), stage_(dim){};
         ~Heun(){};
 
     public:
@@ -73,12 +83,39 @@ OdeSystem
 #endif
 
             system(old_time, temp_);
-            new_time.assign(old_time + dT_ * (0.5 * temp_ + 0.5 * system(old_time + dT_ * temp_)));
+            stage_.assign(old_time + dT_ * temp_);
+            system(stage_, rhs_);
+            new_time.assign(old_time + dT_ * (0.5 * temp_ + 0.5 * rhs_));
 
 #ifdef DMETHODS
             std::cout << "New time: " << new_time << std::endl;
 #endif
         }
+
+        // adjoint holds dL/dx of new_time on input and dL/dx of old_time on output, dL/dp is added to gradient
+        template <typename v1, typename v2, typename v3, typename v4>
+        void adjoint_step(const OdeSystem &system, const v1 &old_time, const v2 &, v3 &adjoint, v4 &gradient)
+        {
+            assert(old_time.size() == dim);
+            assert(adjoint.size() == dim);
+            assert(gradient.size() == OdeSystem::no_params);
+            jacobian_type<OdeSystem> jac_old, jac_stage;
+            small_matrix<value_type, dim, OdeSystem::no_params> param_jac_old, param_jac_stage;
+            state_type<OdeSystem> w, mu;
+
+            // recompute intermediate stage of time_step
+            system(old_time, temp_);
+            stage_.assign(old_time + dT_ * temp_);
+            system.jacobian(old_time, jac_old);
+            system.jacobian(stage_, jac_stage);
+            system.parameter_jacobian(old_time, param_jac_old);
+            system.parameter_jacobian(stage_, param_jac_stage);
+
+            w.assign(ublas::prod(ublas::trans(jac_stage), adjoint));
+            mu.assign(adjoint + dT_ * w);
+            noalias(gradient) += 0.5 * dT_ * (ublas::prod(ublas::trans(param_jac_old), mu) + ublas::prod(ublas::trans(param_jac_stage), adjoint));
+            noalias(adjoint) += 0.5 * dT_ * (ublas::prod(ublas::trans(jac_old), mu) + w);
+        }
     };
 } // namespace ode
 #endif
@@ -0,0 +1,87 @@
+#ifndef HEUNBATCH_HPP
+#define HEUNBATCH_HPP
+/*
+    Heun method advancing a batch of ODE systems (one per lane) at once.
+*/
+
+#include <cassert>
+#include <iostream>
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+BatchSchemeType
+    constructor:
+        BatchSchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type, state_type, system_type
+    member functions:
+        void time_step(const BatchOdeSystem &system, const state_type &old_time, state_type &new_time)
+    static variables:
+        size_type dim
+        size_type lanes
+        char[] method_name
+
+
+    Uses concepts:
+BatchOdeSystem
+    member types:
+        size_type, value_type, state_type (dim x lanes, row major)
+    member functions:
+        void initial_condition(state_type &state) const
+        void operator()(const state_type &variables, state_type &return_state)
+    static variables:
+        size_type dim
+        size_type lanes
+*/
+
+    template <typename BatchOdeSystem>
+    class HeunBatch
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename BatchOdeSystem::value_type>::value,
+                                        typename BatchOdeSystem::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename BatchOdeSystem::size_type>::value,
+                                        typename BatchOdeSystem::size_type>::type size_type;
+        typedef typename BatchOdeSystem::state_type state_type;
+        typedef BatchOdeSystem system_type;
+
+    private:
+        value_type dT_;
+        state_type k1_, k2_, stage_;
+
+    public:
+        static const char constexpr method_name[] = "heun";
+        static const size_type constexpr dim = BatchOdeSystem::dim;
+        static const size_type constexpr lanes = BatchOdeSystem::lanes;
+
+    public:
+        HeunBatch(){};
+        HeunBatch(const size_type steps, const value_type final_time)
+            : dT_(final_time / (value_type)steps){};
+        ~HeunBatch(){};
+
+    public:
+        inline void time_step(const BatchOdeSystem &system, const state_type &old_time, state_type &new_time)
+        {
+            const value_type *x = &old_time(0, 0), *k1 = &k1_(0, 0), *k2 = &k2_(0, 0);
+            value_type *stage = &stage_(0, 0), *x_new = &new_time(0, 0);
+
+            system(old_time, k1_);
+            for (size_type i = 0; i < dim * lanes; i++)
+            {
+                stage[i] = x[i] + dT_ * k1[i];
+            }
+            system(stage_, k2_);
+            for (size_type i = 0; i < dim * lanes; i++)
+            {
+                x_new[i] = x[i] + dT_ * (0.5 * k1[i] + 0.5 * k2[i]);
+            }
+#ifdef DMETHODS
+            std::cout << "New time: " << new_time << std::endl;
+#endif
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,109 @@
+#ifndef JACOBIANSTRUCTURE_HPP
+#define JACOBIANSTRUCTURE_HPP
+/*
+    Structure of jacobian declared by an OdeSystem (typedef ... jacobian_structure), dense if it declares none.
+    Implicit schemes take the matrix type passed to OdeSystem::jacobian and the factorization of their
+    iteration matrix from newton_matrix, so large sparse systems never allocate a dim x dim matrix.
+    Matrix free structure needs no jacobian at all, implicit schemes solve with GMRES on finite differences
+    of the right hand side instead (it may also be passed to a scheme for a system declaring a jacobian).
+*/
+
+#include <type_traits>
+
+#include "stateType.hpp"
+#include "smallLU.hpp"
+#include "csrMatrix.hpp"
+#include "sparseLU.hpp"
+#include "diagonalMatrix.hpp"
+#include "bandedMatrix.hpp"
+#include "gmres.hpp"
+
+namespace ode
+{
+    struct dense_jacobian // c_matrix dim x dim, SmallLU
+    {
+    };
+    struct sparse_jacobian // CsrMatrix with pattern set by OdeSystem::jacobian when empty, SparseLU
+    {
+    };
+    struct diagonal_jacobian // DiagonalMatrix, DiagonalLU
+    {
+    };
+    template <std::size_t Lower, std::size_t Upper>
+    struct banded_jacobian // BandedMatrix with Lower subdiagonals and Upper superdiagonals, BandedLU
+    {
+    };
+    struct matrix_free // no jacobian, Gmres on products of iteration matrix with vectors
+    {
+    };
+
+    template <typename OdeSystem, typename = void>
+    struct jacobian_structure
+    {
+        typedef dense_jacobian type;
+    };
+
+    template <typename OdeSystem>
+    struct jacobian_structure<OdeSystem, std::void_t<typename OdeSystem::jacobian_structure>>
+    {
+        typedef typename OdeSystem::jacobian_structure type;
+    };
+
+    template <typename OdeSystem, typename Structure = typename jacobian_structure<OdeSystem>::type>
+    struct newton_matrix;
+
+    template <typename OdeSystem>
+    struct newton_matrix<OdeSystem, dense_jacobian>
+    {
+        typedef jacobian_type<OdeSystem> matrix_type;
+        typedef SmallLU<typename OdeSystem::value_type, OdeSystem::dim> lu_type;
+    };
+
+    template <typename OdeSystem>
+    struct newton_matrix<OdeSystem, sparse_jacobian>
+    {
+        typedef CsrMatrix<typename OdeSystem::value_type, typename OdeSystem::size_type> matrix_type;
+        typedef SparseLU<typename OdeSystem::value_type, typename OdeSystem::size_type> lu_type;
+    };
+
+    template <typename OdeSystem>
+    struct newton_matrix<OdeSystem, diagonal_jacobian>
+    {
+        typedef DiagonalMatrix<typename OdeSystem::value_type, typename OdeSystem::size_type> matrix_type;
+        typedef DiagonalLU<typename OdeSystem::value_type, typename OdeSystem::size_type> lu_type;
+    };
+
+    template <typename OdeSystem, std::size_t Lower, std::size_t Upper>
+    struct newton_matrix<OdeSystem, banded_jacobian<Lower, Upper>>
+    {
+        typedef BandedMatrix<typename OdeSystem::value_type, Lower, Upper, typename OdeSystem::size_type> matrix_type;
+        typedef BandedLU<typename OdeSystem::value_type, Lower, Upper, typename OdeSystem::size_type> lu_type;
+    };
+
+    // factorization with storage of runtime size (diagonal, banded) is sized up front, so the first step
+    // of a solve does not allocate
+    template <typename lu_type, typename size_type>
+    lu_type sized_lu(const size_type dim)
+    {
+        if constexpr (std::is_constructible<lu_type, size_type, size_type>::value)
+            return lu_type(dim, dim);
+        else
+            return lu_type();
+    }
+
+    // nothing is stored, lu_type is the Krylov solver
+    struct no_matrix
+    {
+        no_matrix(){};
+        template <typename size_type>
+        no_matrix(const size_type, const size_type){};
+    };
+
+    template <typename OdeSystem>
+    struct newton_matrix<OdeSystem, matrix_free>
+    {
+        typedef no_matrix matrix_type;
+        typedef Gmres<typename OdeSystem::value_type, OdeSystem::dim> lu_type;
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,199 @@
+#ifndef NEWTONSOLVER_HPP
+#define NEWTONSOLVER_HPP
+/*
+    Newton solver of the implicit equation y = base + alpha * f(y) shared by implicit schemes
+    (EulerBackward, BDF2, TrBdf2), iteration matrix is (alpha*J - I).
+    Full Newton factorizes in every iteration, simplified Newton keeps the factorization over iterations and
+    steps while they contract fast enough and alpha stays the same.
+    Iteration matrix is dense, diagonal, banded or sparse as declared by OdeSystem (see jacobianStructure.hpp),
+    with matrix_free structure corrections come from GMRES on finite differences of the right hand side.
+*/
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "jacobianStructure.hpp"
+#include "../profiling/counters.hpp"
+
+namespace ode
+{
+    // Newton variants of implicit schemes
+    struct full_newton       // jacobian and factorization in every iteration
+    {
+    };
+    struct simplified_newton // factorization kept while iterations contract fast enough
+    {
+    };
+
+    /*
+    Uses concepts:
+OdeSystem
+    member types:
+        size_type, value_type
+    member functions:
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &output_matrix )           output_matrix is newton_matrix<OdeSystem>::matrix_type,
+                                                               not used with matrix_free
+    static variables:
+        size_type dim
+    */
+    template <typename OdeSystem, typename NewtonType = full_newton,
+              typename Structure = typename jacobian_structure<OdeSystem>::type>
+    class NewtonSolver
+    {
+    public:
+        typedef typename OdeSystem::value_type value_type;
+        typedef typename OdeSystem::size_type size_type;
+        typedef typename newton_matrix<OdeSystem, Structure>::matrix_type matrix_type;
+        typedef typename newton_matrix<OdeSystem, Structure>::lu_type lu_type;
+
+    private:
+        state_type<OdeSystem> temp_, rhs_;
+        matrix_type jac_;
+        lu_type lu_;                                   // factorization, or GMRES with matrix_free
+        bool factorized_;                              // lu_ holds (factorized_alpha_*J - I) usable by simplified newton
+        value_type factorized_alpha_;
+        state_type<OdeSystem> shifted_, rhs_shifted_; // matrix_free: x + eps * v and its right hand side
+
+        // method private settings
+        static const value_type constexpr tolerance = std::numeric_limits<value_type>::epsilon() * 100.0;
+        static const size_type constexpr max_iter = 1000;
+        static const value_type constexpr max_contraction = 1e-4; // simplified newton refactorizes above this residual ratio
+        static const value_type constexpr krylov_tolerance = 1e-6; // relative residual of GMRES corrections (matrix_free)
+        static const size_type constexpr max_krylov = 300;
+
+    public:
+        static const size_type constexpr dim = OdeSystem::dim;
+        static constexpr bool simplified = std::is_same<NewtonType, simplified_newton>::value;
+        static constexpr bool matrix_free_ = std::is_same<Structure, matrix_free>::value;
+
+    public:
+        NewtonSolver()
+            : temp_(dim), rhs_(dim), jac_(dim, dim), lu_(sized_lu<lu_type>(dim)), factorized_(false),
+              factorized_alpha_(0.0), shifted_(dim), rhs_shifted_(dim){};
+        ~NewtonSolver(){};
+
+    public:
+        // solve converged if its residual is below tolerance (infinite or nan if the iteration blew up)
+        static bool converged(const value_type res) { return res < tolerance; }
+
+        // y holds initial guess on input and solution on output, returns scaled residual of the last iterate
+        template <typename v1, typename v2>
+        value_type solve(const OdeSystem &system, const v1 &base, const value_type alpha, v2 &y)
+        {
+            assert((decltype(dim))base.size() == dim);
+            assert((decltype(y.size()))base.size() == y.size());
+            value_type res = std::numeric_limits<value_type>::infinity();
+            value_type norm = ublas::norm_1(base);
+#ifdef DMETHODS
+            std::cout << "Normalizer: " << norm << std::endl;
+            bool converged = false;
+#endif
+            value_type res_old = std::numeric_limits<value_type>::infinity();
+            size_type i;
+            for (i = 0; i < max_iter; i++)
+            {
+                // check convergence
+                system(y, rhs_);
+                temp_.assign((base - y) + alpha * rhs_);
+                res = ublas::norm_inf(temp_) / norm;
+                if (res < tolerance)
+                {
+#ifdef DMETHODS
+                    converged = true;
+#endif
+                    break;
+                }
+                // solution blew up (e.g. unstable trial parameters), more iterations cannot help
+                if (!std::isfinite(res))
+                {
+                    break;
+                }
+
+                profiling::count(profiling::Event::newton_iteration);
+                if constexpr (matrix_free_)
+                {
+                    // (alpha*J - I) v by forward difference of the right hand side around y, rhs_ holds f(y)
+                    const value_type scale = std::sqrt(std::numeric_limits<value_type>::epsilon()) *
+                                             (1.0 + ublas::norm_2(y));
+                    auto iteration_matrix = [&](const auto &v, auto &result) {
+                        const value_type norm_v = ublas::norm_2(v);
+                        if (!(norm_v > 0.0))
+                        {
+                            result.clear();
+                            return;
+                        }
+                        const value_type eps = scale / norm_v;
+                        shifted_.assign(y + eps * v);
+                        system(shifted_, rhs_shifted_);
+                        result.assign((alpha / eps) * (rhs_shifted_ - rhs_) - v);
+                    };
+                    // correction of GMRES stopped at max_krylov is not a Newton step, iteration fails like a blow up
+                    if (lu_.solve(iteration_matrix, temp_, krylov_tolerance, max_krylov) >= max_krylov)
+                    {
+                        break;
+                    }
+                }
+                else
+                {
+                    // simplified newton keeps the old factorization while it contracts
+                    if (!simplified || !factorized_ || alpha != factorized_alpha_ || res > max_contraction * res_old)
+                    {
+                        factorize(system, y, alpha);
+                    }
+                    res_old = res;
+
+                    // compute inversion
+                    lu_.solve(temp_);
+                }
+
+                // new iteration
+                y.assign(y - temp_);
+            }
+
+#ifdef DMETHODS
+            if (converged)
+            {
+                std::cout << "Newton converged in " << i + 1 << " steps." << std::endl
+                          << std::endl;
+            }
+            else
+            {
+                std::cout << "Newton did not converge! " << std::endl;
+                std::exit(1);
+            }
+            std::cout << "Residual: " << res << std::endl;
+#endif
+            return res;
+        }
+
+        // factorizes (alpha*J - I) at y, reusable = false keeps simplified newton from using it (e.g. adjoint steps)
+        template <typename vector>
+        void factorize(const OdeSystem &system, const vector &y, const value_type alpha, const bool reusable = true)
+        {
+            static_assert(!matrix_free_, "factorization needs jacobian of OdeSystem");
+            system.jacobian(y, jac_);
+            jac_ *= alpha;
+            for (size_t i = 0; i < jac_.size1(); i++)
+            {
+                jac_(i, i) -= 1.0;
+            }
+            lu_.factorize(jac_);
+            factorized_ = reusable;
+            factorized_alpha_ = alpha;
+            profiling::count(profiling::Event::factorization);
+        }
+
+        // factorization of the last factorize call
+        const lu_type &lu() const { return lu_; }
+    };
+} // namespace ode
+#endif
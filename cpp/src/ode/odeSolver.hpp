@@ -2,17 +2,24 @@
 #define ODESOLVERS_HPP
 /*
     OdeSolver class that uses method to solve a system of ODE until target time T with N steps.
+    Either stores every state to a matrix, or keeps only two states and hands every state over to an observer.
 */
 
 #include <cassert>
 #include <iostream>
 #include <algorithm>
+#include <type_traits>
+#include <utility>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 
 namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "../profiling/counters.hpp"
+
 namespace ode
 {
     /*
@@ -23,7 +30,9 @@ OdeSolver
     member types:
         size_type, value_type
     member functions:
-        void solve(matrix_type &results_matrix)
+        void solve(OdeSystem &ode_sys, matrix_type &results_matrix)
+        bool solve(OdeSystem &ode_sys, observer_type &observer)
+        SchemeType &method()                                   e.g. tolerances of adaptive schemes
     static variables:
         size_type dim
 
@@ -36,6 +45,7 @@ SchemeType
         size_type, value_type
     member functions:
         void time_step(const OdeSystem &ode_sys, const vector_type &old_time, vector_type &new_time)
+        void restart()      (optional) schemes keeping state between steps forget it, called before every solve
     static variables:
         size_type dim
         char[] method_name
@@ -51,8 +61,23 @@ OdeSystem
         void jacobian()( variables, &output_matrix )
     static variables:
         size_type dim
+
+observer_type
+    member functions:
+        void operator()(size_type step, const state_type &state)
+        or bool operator()(size_type step, const state_type &state)   returning false stops the solve
 */
 
+    template <typename SchemeType, typename = void>
+    struct has_restart : std::false_type
+    {
+    };
+
+    template <typename SchemeType>
+    struct has_restart<SchemeType, std::void_t<decltype(std::declval<SchemeType &>().restart())>> : std::true_type
+    {
+    };
+
     template <typename SchemeType>
     class OdeSolver
     {
@@ -77,8 +102,11 @@ OdeSystem
         OdeSolver(const int noSteps, const value_type maxTime)
             : N_(noSteps), T_(maxTime), method_(N_, T_){};
 
+        SchemeType &method() { return method_; }
+
         // solve ode system using method_, put results to results_matrix, first column is assigned initial condition
-        template <typename OdeSystem, typename matrix_type> //should be column major
+        template <typename OdeSystem, typename matrix_type, //should be column major
+                  typename std::enable_if<!std::is_invocable<matrix_type &, size_type, const state_type<OdeSystem> &>::value, int>::type = 0>
         void solve(OdeSystem &ode_sys, matrix_type &results_matrix)
         {
 #ifdef DODESOLVER
@@ -95,7 +123,8 @@ OdeSystem
 
             // assign inital condition to first column
             auto init = ublas::column(results_matrix, 0);
-            init = ode_sys.initial_condition();
+            init.assign(ode_sys.initial_condition());
+            restart();
 #ifdef DODESOLVER
             std::cout << "Initial condition: " << std::endl
                       << init << std::endl;
@@ -114,6 +143,7 @@ OdeSystem
                               << std::endl;
 #endif
             }
+            profiling::count(profiling::Event::time_step, N_);
 #ifdef DODESOLVER
             std::cout << "Last values: " << std::endl
                       << "First variable:  " << results_matrix(0, N_) << std::endl
@@ -121,6 +151,67 @@ OdeSystem
                       << std::endl;
 #endif
         };
+
+        // solve ode system using method_ keeping only two states, observer gets every state including the initial condition
+        // returns false if observer stopped the solve before final time
+        template <typename OdeSystem, typename observer_type,
+                  typename std::enable_if<std::is_invocable<observer_type &, size_type, const state_type<OdeSystem> &>::value, int>::type = 0>
+        bool solve(OdeSystem &ode_sys, observer_type &observer)
+        {
+#ifdef DODESOLVER
+            std::cout << "Solving ODE ode_sys using " << SchemeType::method_name << " with observer" << std::endl;
+#endif
+            state_type<OdeSystem> states[2];
+            states[0].assign(ode_sys.initial_condition());
+            restart();
+            if (!observe(observer, 0, states[0]))
+                return false;
+            for (size_type step = 0; step < N_; step++)
+            {
+                // two buffers swap roles every step
+                const state_type<OdeSystem> &old_time = states[step % 2];
+                state_type<OdeSystem> &new_time = states[(step + 1) % 2];
+                method_.time_step(ode_sys, old_time, new_time);
+                if (!observe(observer, step + 1, new_time))
+                {
+#ifdef DODESOLVER
+                    std::cout << "Stopped by observer after " << step + 1 << " steps." << std::endl;
+#endif
+                    profiling::count(profiling::Event::time_step, step + 1);
+                    return false;
+                }
+            }
+            profiling::count(profiling::Event::time_step, N_);
+#ifdef DODESOLVER
+            std::cout << "Last values: " << std::endl
+                      << "First variable:  " << states[N_ % 2][0] << std::endl
+                      << "Last variable:   " << states[N_ % 2][OdeSystem::dim - 1]
+                      << std::endl;
+#endif
+            return true;
+        };
+
+    private:
+        inline void restart()
+        {
+            if constexpr (has_restart<SchemeType>::value)
+                method_.restart();
+        }
+
+        // observers returning void never stop the solve
+        template <typename observer_type, typename vector_type>
+        static inline bool observe(observer_type &observer, const size_type step, const vector_type &state)
+        {
+            if constexpr (std::is_same<decltype(observer(step, state)), bool>::value)
+            {
+                return observer(step, state);
+            }
+            else
+            {
+                observer(step, state);
+                return true;
+            }
+        }
     };
 } // namespace ode
 #endif
@@ -0,0 +1,181 @@
+#ifndef ODE_SYSTEM_SENSITIVITY_HPP
+#define ODE_SYSTEM_SENSITIVITY_HPP
+/*
+    ODE system augmented with forward sensitivities dx/dp of all its parameters.
+    Variables are stored as [x, dx/dp_1, ..., dx/dp_m], each block of size OdeSystem::dim.
+*/
+
+#include <cassert>
+#include <type_traits>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/ublas/vector_proxy.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+namespace ode
+{
+    /*
+////Satisfies concepts:
+OdeSystem
+    member types:
+        size_type, value_type
+    member functions:
+        vector_type initial_condition() const
+        vector_type operator()( vector_type )
+        return_vector operator()(const v1 &variables_vector)
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &output_matrix )
+    static variables:
+        size_type dim
+
+
+////Uses concepts:
+ParametricOdeSystem (OdeSystem with parameters)
+    member functions:
+        void set_parameters(vector_type)
+        void set_initial_condition(vector_type)
+        void parameter_jacobian()( variables, &output_matrix )
+    static variables:
+        size_type no_params
+    */
+    template <typename OdeSystem>
+    class OdeSys_sensitivity
+    {
+    public:
+        typedef typename OdeSystem::size_type size_type;
+        typedef typename OdeSystem::value_type value_type;
+
+    public:
+        static const size_type state_dim = OdeSystem::dim;
+        static const size_type no_params = OdeSystem::no_params;
+        static const size_type dim = state_dim * (1 + no_params);
+
+        // fixed size, returned by value without heap allocation
+        typedef ublas::c_vector<value_type, dim> state_type;
+
+    private:
+        OdeSystem system_;
+        mutable ublas::c_matrix<value_type, state_dim, state_dim> jac_;
+        mutable ublas::c_matrix<value_type, state_dim, no_params> param_jac_;
+        mutable ublas::c_vector<value_type, state_dim> x_, f_;
+
+    public:
+        OdeSys_sensitivity() : jac_(ublas::zero_matrix<value_type>(state_dim, state_dim)),
+                               param_jac_(ublas::zero_matrix<value_type>(state_dim, no_params)),
+                               x_(ublas::zero_vector<value_type>(state_dim)), f_(x_){};
+        OdeSys_sensitivity(const OdeSystem &system) : OdeSys_sensitivity() { system_ = system; };
+        ~OdeSys_sensitivity(){};
+
+    public:
+        template <typename vector>
+        void set_parameters(const vector &v) { system_.set_parameters(v); }
+        template <typename vector>
+        void set_initial_condition(const vector &v) { system_.set_initial_condition(v); }
+        const OdeSystem &system() const { return system_; }
+
+    public:
+        // sensitivities start from zero, initial condition does not depend on parameters
+        state_type initial_condition() const
+        {
+            state_type ret(dim);
+            ret.clear();
+            ublas::subrange(ret, 0, state_dim).assign(system_.initial_condition());
+            return ret;
+        }
+
+    public:
+        template <typename vector_type>
+        state_type operator()(const vector_type &variables_vector) const
+        {
+            state_type ret_vector(dim);
+            (*this)(variables_vector, ret_vector);
+            return ret_vector;
+        };
+
+        // d/dt [x, s_j] = [f(x), J(x) s_j + df/dp_j(x)]
+        template <typename v1, typename v2>
+        void operator()(const v1 &variables_vector, v2 &return_vector) const
+        {
+            assert((size_type)variables_vector.size() == dim);
+            assert((size_type)return_vector.size() == dim);
+            for (size_type i = 0; i < state_dim; i++)
+            {
+                x_[i] = variables_vector[i];
+            }
+            system_(x_, f_);
+            system_.jacobian(x_, jac_);
+            system_.parameter_jacobian(x_, param_jac_);
+
+            for (size_type i = 0; i < state_dim; i++)
+            {
+                return_vector[i] = f_[i];
+            }
+            for (size_type j = 0; j < no_params; j++)
+            {
+                const size_type offset = (j + 1) * state_dim;
+                for (size_type i = 0; i < state_dim; i++)
+                {
+                    value_type ds = param_jac_(i, j);
+                    for (size_type k = 0; k < state_dim; k++)
+                    {
+                        ds += jac_(i, k) * variables_vector[offset + k];
+                    }
+                    return_vector[offset + i] = ds;
+                }
+            }
+        };
+
+    public:
+        // block diagonal approximation, derivatives of J(x) s_j with respect to x are left out
+        template <typename vector_type, typename matrix_type>
+        void jacobian(const vector_type &variables_vector, matrix_type &jac_matrix) const
+        {
+            assert((size_type)variables_vector.size() == dim);
+            assert(jac_matrix.size1() == dim);
+            assert(jac_matrix.size1() == jac_matrix.size2());
+            for (size_type i = 0; i < state_dim; i++)
+            {
+                x_[i] = variables_vector[i];
+            }
+            system_.jacobian(x_, jac_);
+
+            jac_matrix.clear();
+            for (size_type block = 0; block <= no_params; block++)
+            {
+                const size_type offset = block * state_dim;
+                for (size_type i = 0; i < state_dim; i++)
+                {
+                    for (size_type k = 0; k < state_dim; k++)
+                    {
+                        jac_matrix(offset + i, offset + k) = jac_(i, k);
+                    }
+                }
+            }
+        };
+    };
+
+    // sensitivities integrated by SchemeType are derivatives of its discrete solution, unless the jacobian enters its steps
+    // (linearly_implicit, e.g. Rosenbrock) and so the left out derivatives of J(x) s_j above
+    template <typename SchemeType, typename = void>
+    struct exact_sensitivity : std::true_type
+    {
+    };
+
+    template <typename SchemeType>
+    struct exact_sensitivity<SchemeType, std::enable_if_t<SchemeType::linearly_implicit>> : std::false_type
+    {
+    };
+
+    // SchemeType of the same method for another OdeSystem, e.g. Heun<OdeSys_sensitivity<OdeSystem>>
+    template <typename SchemeType, typename OdeSystem>
+    struct rebind_scheme;
+
+    template <template <typename...> class Scheme, typename OldSystem, typename... Rest, typename OdeSystem>
+    struct rebind_scheme<Scheme<OldSystem, Rest...>, OdeSystem>
+    {
+        typedef Scheme<OdeSystem, Rest...> type;
+    };
+} // namespace ode
+#endif
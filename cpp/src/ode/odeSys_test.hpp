@@ -1,5 +1,5 @@
-#ifndef ODE_SYSTEM_SIQRD_HPP
-#define ODE_SYSTEM_SIQRD_HPP
+#ifndef ODE_SYSTEM_TEST_HPP
+#define ODE_SYSTEM_TEST_HPP
 /*
     System of ODE dx/dt_n(t) = − 10 (x_n − (n-1)/10.0)^3 for n in 1:50
 */
@@ -13,19 +13,21 @@
 
 namespace ublas = boost::numeric::ublas;
 
+#include "jacobianStructure.hpp"
+
 namespace ode
 {
     /*
 ////Satisfies concepts:
 OdeSystem 
     member types:
-        size_type, value_type
+        size_type, value_type, jacobian_structure (diagonal_jacobian)
     member functions:
         vector_type initial_condition() const
         vector_type operator()( vector_type )
         return_vector operator()(const v1 &variables_vector)
         void operator()(const v1 &variables_vector, v2 &return_vector)
-        void jacobian()( variables, &output_matrix )
+        void jacobian()( variables, &DiagonalMatrix )
     static variables:
         size_type dim
     */
@@ -35,17 +37,21 @@ OdeSystem
     public:
         typedef typename std::enable_if<std::is_integral<SizeType>::value, SizeType>::type size_type;
         typedef typename std::enable_if<std::is_floating_point<Type>::value, Type>::type value_type;
+        typedef diagonal_jacobian jacobian_structure; // equations are decoupled
 
         static const size_type dim = 50;
 
+        // fixed size, returned by value without heap allocation
+        typedef ublas::c_vector<value_type, dim> state_type;
+
         OdeSys_test(){};
         ~OdeSys_test(){};
 
     public:
         //     Initial condition [0.01 0.02 0.03 ... 0.5]
-        auto initial_condition() const
+        state_type initial_condition() const
         {
-            ublas::vector<value_type> ret(dim);
+            state_type ret(dim);
             int i = 0;
             auto fun = [&i]() { return ++i * 0.01; };
             std::generate(ret.begin(), ret.end(), fun);
@@ -86,10 +92,10 @@ OdeSystem
 
     public:
         template <typename vector_type>
-        auto operator()(const vector_type &variables_vector) const
+        state_type operator()(const vector_type &variables_vector) const
         {
             assert(variables_vector.size() == dim);
-            ublas::vector<value_type> ret_vector(dim);
+            state_type ret_vector(dim);
             for (size_type i = 0; i < dim; i++)
             {
                 ret_vector[i] = -10 * std::pow((variables_vector[i] - 0.1 * i), 3);
@@ -0,0 +1,102 @@
+#ifndef ODE_SYSTEM_TEST_BANDED_HPP
+#define ODE_SYSTEM_TEST_BANDED_HPP
+/*
+    System of ODE dx_n/dt = x_n-1 - 2 x_n + x_n+1 for n in 1:50, x_0 = x_51 = 0 (discrete heat equation)
+    Jacobian is tridiagonal, initial condition is the slowest eigenvector, so the solution only decays.
+*/
+
+#include <cassert>
+#include <cmath>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+namespace ublas = boost::numeric::ublas;
+
+#include "jacobianStructure.hpp"
+
+namespace ode
+{
+    /*
+////Satisfies concepts:
+OdeSystem
+    member types:
+        size_type, value_type, jacobian_structure (banded_jacobian<1, 1>)
+    member functions:
+        vector_type initial_condition() const
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &BandedMatrix )    any matrix with operator()(i, j) and clear() (e.g. c_matrix)
+    static variables:
+        size_type dim
+    */
+    template <typename Type = double, typename SizeType = typename ublas::vector<Type>::size_type>
+    class OdeSys_test_banded
+    {
+    public:
+        typedef typename std::enable_if<std::is_integral<SizeType>::value, SizeType>::type size_type;
+        typedef typename std::enable_if<std::is_floating_point<Type>::value, Type>::type value_type;
+        typedef banded_jacobian<1, 1> jacobian_structure;
+
+        static const size_type dim = 50;
+
+        typedef ublas::c_vector<value_type, dim> state_type;
+
+        OdeSys_test_banded(){};
+        ~OdeSys_test_banded(){};
+
+    public:
+        //     Initial condition sin(pi n / 51)
+        state_type initial_condition() const
+        {
+            state_type ret(dim);
+            for (size_type i = 0; i < dim; i++)
+            {
+                ret[i] = std::sin(M_PI * (i + 1) / (dim + 1));
+            }
+            return ret;
+        }
+
+        // eigenvalue of initial condition is -4 sin^2(pi / 102)
+        auto analytic_solution(value_type t) const
+        {
+            const value_type s = std::sin(M_PI / (2 * (dim + 1)));
+            ublas::vector<value_type> ret(initial_condition());
+            ret *= std::exp(-4 * s * s * t);
+            return ret;
+        }
+
+    public:
+        template <typename v1, typename v2>
+        void operator()(const v1 &variables_vector, v2 &return_vector) const
+        {
+            assert(variables_vector.size() == dim);
+            assert(return_vector.size() == dim);
+            for (size_type i = 0; i < dim; i++)
+            {
+                return_vector[i] = -2 * variables_vector[i];
+                if (i > 0)
+                    return_vector[i] += variables_vector[i - 1];
+                if (i + 1 < dim)
+                    return_vector[i] += variables_vector[i + 1];
+            }
+        };
+
+        template <typename vector_type, typename matrix_type>
+        void jacobian([[maybe_unused]] const vector_type &variables_vector, matrix_type &jac_matrix) const
+        {
+            assert(variables_vector.size() == dim);
+            assert(jac_matrix.size1() == dim && jac_matrix.size2() == dim);
+
+            jac_matrix.clear();
+            for (size_type i = 0; i < dim; i++)
+            {
+                jac_matrix(i, i) = -2;
+                if (i > 0)
+                    jac_matrix(i, i - 1) = 1;
+                if (i + 1 < dim)
+                    jac_matrix(i, i + 1) = 1;
+            }
+        };
+    };
+} // namespace ode
+#endif
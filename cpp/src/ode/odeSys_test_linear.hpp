@@ -0,0 +1,99 @@
+#ifndef ODE_SYSTEM_TEST_LINEAR_HPP
+#define ODE_SYSTEM_TEST_LINEAR_HPP
+/*
+    System of ODE dx_n/dt = − n/10 x_n for n in 1:50, x_n(0) = 1
+    Decoupled linear decay with rates up to 5, the error of a scheme is a power series of step size times rate,
+    so ratios of errors show its order already at moderate step counts.
+*/
+
+#include <cassert>
+#include <cmath>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+namespace ublas = boost::numeric::ublas;
+
+#include "jacobianStructure.hpp"
+
+namespace ode
+{
+    /*
+////Satisfies concepts:
+OdeSystem
+    member types:
+        size_type, value_type, jacobian_structure (diagonal_jacobian)
+    member functions:
+        vector_type initial_condition() const
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &DiagonalMatrix )
+    static variables:
+        size_type dim
+    */
+    template <typename Type = double, typename SizeType = typename ublas::vector<Type>::size_type>
+    class OdeSys_test_linear
+    {
+    public:
+        typedef typename std::enable_if<std::is_integral<SizeType>::value, SizeType>::type size_type;
+        typedef typename std::enable_if<std::is_floating_point<Type>::value, Type>::type value_type;
+        typedef diagonal_jacobian jacobian_structure;
+
+        static const size_type dim = 50;
+
+        typedef ublas::c_vector<value_type, dim> state_type;
+
+        OdeSys_test_linear(){};
+        ~OdeSys_test_linear(){};
+
+    public:
+        //     Initial condition [1 1 ... 1]
+        state_type initial_condition() const
+        {
+            state_type ret(dim);
+            for (size_type i = 0; i < dim; i++)
+            {
+                ret[i] = 1.0;
+            }
+            return ret;
+        }
+
+        auto analytic_solution(value_type t) const
+        {
+            ublas::vector<value_type> ret(dim);
+            for (size_type i = 0; i < dim; i++)
+            {
+                ret[i] = std::exp(-rate(i) * t);
+            }
+            return ret;
+        }
+
+    public:
+        template <typename v1, typename v2>
+        void operator()(const v1 &variables_vector, v2 &return_vector) const
+        {
+            assert(variables_vector.size() == dim);
+            assert(return_vector.size() == dim);
+            for (size_type i = 0; i < dim; i++)
+            {
+                return_vector[i] = -rate(i) * variables_vector[i];
+            }
+        };
+
+        template <typename vector_type, typename matrix_type>
+        void jacobian([[maybe_unused]] const vector_type &variables_vector, matrix_type &jac_matrix) const
+        {
+            assert(variables_vector.size() == dim);
+            assert(jac_matrix.size1() == dim && jac_matrix.size2() == dim);
+
+            jac_matrix.clear();
+            for (size_type i = 0; i < dim; i++)
+            {
+                jac_matrix(i, i) = -rate(i);
+            }
+        };
+
+    private:
+        static value_type rate(const size_type i) { return 0.1 * (i + 1); }
+    };
+} // namespace ode
+#endif
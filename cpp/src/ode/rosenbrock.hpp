@@ -0,0 +1,218 @@
+#ifndef ROSENBROCK_HPP
+#define ROSENBROCK_HPP
+/*
+    Rosenbrock (linearly implicit Runge-Kutta) methods for stiff systems given by a compile time tableau.
+    Every step evaluates the jacobian and factorizes (gamma*dT*J - I) once, stages are linear solves with it,
+    there is no Newton iteration. Stages use the form of Hairer, Wanner: Solving ODE II, IV.7,
+        (1/(gamma dT) I - J) U_i = f(y_n + sum_j<i a_ij U_j) + sum_j<i c_ij/dT U_j,   y_n+1 = y_n + sum_i m_i U_i
+    for autonomous systems. Order is only reached with exact jacobian, so matrix_free structure is not supported.
+*/
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "jacobianStructure.hpp"
+#include "../profiling/counters.hpp"
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+RosenbrockTableau
+    static variables:
+        std::size_t stages, order
+        double gamma
+        double a[stages][stages], c[stages][stages]   strictly lower triangular
+        double m[stages]
+        char[] name
+    */
+
+    // 2nd order L-stable method with two stages (Verwer et al. 1999)
+    struct ros2_tableau
+    {
+        static const std::size_t constexpr stages = 2;
+        static const std::size_t constexpr order = 2;
+        static constexpr double gamma = 1.0 + M_SQRT1_2;
+        static constexpr double a[stages][stages] = {{0.0, 0.0},
+                                                     {1.0 / gamma, 0.0}};
+        static constexpr double c[stages][stages] = {{0.0, 0.0},
+                                                     {-2.0 / gamma, 0.0}};
+        static constexpr double m[stages] = {3.0 / (2.0 * gamma), 1.0 / (2.0 * gamma)};
+        static const char constexpr name[] = "ros2";
+    };
+
+    // 3rd order L-stable, stiffly accurate method with four stages (Sandu et al. 1997)
+    struct rodas3_tableau
+    {
+        static const std::size_t constexpr stages = 4;
+        static const std::size_t constexpr order = 3;
+        static constexpr double gamma = 0.5;
+        static constexpr double a[stages][stages] = {{0.0, 0.0, 0.0, 0.0},
+                                                     {0.0, 0.0, 0.0, 0.0},
+                                                     {2.0, 0.0, 0.0, 0.0},
+                                                     {2.0, 0.0, 1.0, 0.0}};
+        static constexpr double c[stages][stages] = {{0.0, 0.0, 0.0, 0.0},
+                                                     {4.0, 0.0, 0.0, 0.0},
+                                                     {1.0, -1.0, 0.0, 0.0},
+                                                     {1.0, -1.0, -8.0 / 3.0, 0.0}};
+        static constexpr double m[stages] = {2.0, 0.0, 1.0, 1.0};
+        static const char constexpr name[] = "rodas3";
+    };
+
+    // stage i evaluates right hand side at y_n + sum_j<i a_ij U_j, stages with zero row of a reuse f(y_n)
+    template <typename Tableau>
+    constexpr bool stage_at_old_time(const std::size_t i)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            if (Tableau::a[i][j] != 0.0)
+                return false;
+        }
+        return true;
+    }
+
+    /*
+    Satisfies concepts:
+SchemeType
+    constructor:
+        SchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type
+    member functions:
+        void time_step(const OdeSystem &system, const vector_type &old_time, vector_type &new_time)
+    static variables:
+        size_type dim, order
+        bool linearly_implicit                                            jacobian enters the step (see exact_sensitivity)
+        char[] method_name
+
+
+    Uses concepts:
+RosenbrockTableau
+
+OdeSystem
+    member types:
+        size_type, value_type
+    member functions:
+        vector_type initial_condition() const
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &output_matrix )           output_matrix is newton_matrix<OdeSystem>::matrix_type
+    member types:
+        jacobian_structure (optional, any but matrix_free)
+    static variables:
+        size_type dim
+*/
+
+    template <typename OdeSystem, typename Tableau,
+              typename Structure = typename jacobian_structure<OdeSystem>::type>
+    class Rosenbrock
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename OdeSystem::value_type>::value,
+                                        typename OdeSystem::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename OdeSystem::size_type>::value,
+                                        typename OdeSystem::size_type>::type size_type;
+        typedef Tableau tableau;
+
+    private:
+        static const size_type constexpr stages = Tableau::stages;
+        static_assert(!std::is_same<Structure, matrix_free>::value, "Rosenbrock methods need jacobian of OdeSystem");
+
+        value_type dT_;
+        std::array<state_type<OdeSystem>, stages> u_; // stage increments U_i
+        state_type<OdeSystem> f0_, stage_, rhs_;
+        typename newton_matrix<OdeSystem, Structure>::matrix_type jac_;
+        typename newton_matrix<OdeSystem, Structure>::lu_type lu_;
+
+    public:
+        static constexpr const char *method_name = Tableau::name;
+        static const size_type constexpr dim = OdeSystem::dim;
+        static const size_type constexpr order = Tableau::order;
+        static const bool constexpr linearly_implicit = true;
+
+    public:
+        Rosenbrock(){};
+        Rosenbrock(const value_type steps, const value_type final_time)
+            : dT_(final_time / steps), f0_(dim), stage_(dim), rhs_(dim), jac_(dim, dim),
+              lu_(sized_lu<typename newton_matrix<OdeSystem, Structure>::lu_type>(dim)){};
+        ~Rosenbrock(){};
+
+        template <typename v1, typename v2>
+        void time_step(const OdeSystem &system, const v1 &old_time, v2 &new_time)
+        {
+            assert((decltype(dim))old_time.size() == dim);
+            assert((decltype(new_time.size()))old_time.size() == new_time.size());
+#ifdef DMETHODS
+            std::cout << "Old time: " << old_time << std::endl;
+#endif
+            // (gamma*dT*J - I) = -gamma*dT (1/(gamma dT) I - J), so U_i = -gamma*dT * solve(rhs_i)
+            const value_type h_gamma = Tableau::gamma * dT_;
+            system.jacobian(old_time, jac_);
+            jac_ *= h_gamma;
+            for (size_t i = 0; i < jac_.size1(); i++)
+            {
+                jac_(i, i) -= 1.0;
+            }
+            lu_.factorize(jac_);
+            profiling::count(profiling::Event::factorization);
+            system(old_time, f0_);
+
+            for (size_type i = 0; i < stages; i++)
+            {
+                if (stage_at_old_time<Tableau>(i))
+                {
+                    rhs_.assign(f0_);
+                }
+                else
+                {
+                    for (size_type r = 0; r < dim; r++)
+                    {
+                        value_type sum = 0.0;
+                        for (size_type j = 0; j < i; j++)
+                        {
+                            if (Tableau::a[i][j] != 0.0)
+                                sum += Tableau::a[i][j] * u_[j][r];
+                        }
+                        stage_[r] = old_time[r] + sum;
+                    }
+                    system(stage_, rhs_);
+                }
+                for (size_type j = 0; j < i; j++)
+                {
+                    if (Tableau::c[i][j] != 0.0)
+                        noalias(rhs_) += (Tableau::c[i][j] / dT_) * u_[j];
+                }
+                lu_.solve(rhs_);
+                u_[i].assign(-h_gamma * rhs_);
+            }
+
+            for (size_type r = 0; r < dim; r++)
+            {
+                value_type sum = 0.0;
+                for (size_type i = 0; i < stages; i++)
+                {
+                    if (Tableau::m[i] != 0.0)
+                        sum += Tableau::m[i] * u_[i][r];
+                }
+                new_time[r] = old_time[r] + sum;
+            }
+#ifdef DMETHODS
+            std::cout << "New time: " << new_time << std::endl;
+#endif
+        }
+    };
+
+    template <typename OdeSystem, typename Structure = typename jacobian_structure<OdeSystem>::type>
+    using Ros2 = Rosenbrock<OdeSystem, ros2_tableau, Structure>;
+    template <typename OdeSystem, typename Structure = typename jacobian_structure<OdeSystem>::type>
+    using Rodas3 = Rosenbrock<OdeSystem, rodas3_tableau, Structure>;
+} // namespace ode
+#endif
@@ -0,0 +1,136 @@
+#ifndef SMALLLU_HPP
+#define SMALLLU_HPP
+/*
+    LU factorization with partial pivoting of a fixed size N x N matrix.
+    All loop bounds are compile time constants, so for small N the compiler unrolls them completely.
+    Factors of more than max_inline_size values are stored on heap, allocated on construction.
+*/
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "stateType.hpp"
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+SmallLU
+    member functions:
+        void factorize(const matrix_type &matrix)
+        void solve(vector_type &rhs) const               rhs is overwritten by solution of A x = rhs
+        void solve_transposed(vector_type &rhs) const    rhs is overwritten by solution of A^T x = rhs
+    */
+    template <typename Type, std::size_t N>
+    class SmallLU
+    {
+    public:
+        typedef Type value_type;
+        typedef std::size_t size_type;
+
+    private:
+        static constexpr bool inline_ = N * N <= max_inline_size;
+        typedef std::array<value_type, N> row_type;
+
+        std::conditional_t<inline_, std::array<row_type, N>, std::vector<row_type>> lu_{}; // unit lower L below diagonal, U on and above diagonal
+        std::conditional_t<inline_, std::array<size_type, N>, std::vector<size_type>> piv_{}; // row swapped with row i in step i
+
+    public:
+        SmallLU()
+        {
+            if constexpr (!inline_)
+            {
+                lu_.resize(N);
+                piv_.resize(N);
+            }
+        };
+        ~SmallLU(){};
+
+    public:
+        template <typename matrix_type>
+        void factorize(const matrix_type &matrix)
+        {
+            for (size_type i = 0; i < N; i++)
+                for (size_type j = 0; j < N; j++)
+                    lu_[i][j] = matrix(i, j);
+
+            for (size_type k = 0; k < N; k++)
+            {
+                size_type p = k;
+                for (size_type i = k + 1; i < N; i++)
+                {
+                    if (std::abs(lu_[i][k]) > std::abs(lu_[p][k]))
+                        p = i;
+                }
+                piv_[k] = p;
+                if (p != k)
+                {
+                    for (size_type j = 0; j < N; j++)
+                        std::swap(lu_[k][j], lu_[p][j]);
+                }
+                // singular matrix gives inf/nan, which callers detect on the solution
+                const value_type inv_pivot = 1.0 / lu_[k][k];
+                for (size_type i = k + 1; i < N; i++)
+                {
+                    lu_[i][k] *= inv_pivot;
+                    for (size_type j = k + 1; j < N; j++)
+                        lu_[i][j] -= lu_[i][k] * lu_[k][j];
+                }
+            }
+        }
+
+        template <typename vector_type>
+        void solve(vector_type &rhs) const
+        {
+            for (size_type k = 0; k < N; k++)
+            {
+                if (piv_[k] != k)
+                    std::swap(rhs[k], rhs[piv_[k]]);
+            }
+            for (size_type i = 1; i < N; i++)
+            {
+                value_type sum = rhs[i];
+                for (size_type j = 0; j < i; j++)
+                    sum -= lu_[i][j] * rhs[j];
+                rhs[i] = sum;
+            }
+            for (size_type i = N; i-- > 0;)
+            {
+                value_type sum = rhs[i];
+                for (size_type j = i + 1; j < N; j++)
+                    sum -= lu_[i][j] * rhs[j];
+                rhs[i] = sum / lu_[i][i];
+            }
+        }
+
+        // A^T = U^T L^T P, solved as U^T y = rhs, L^T z = y, x = P^T z
+        template <typename vector_type>
+        void solve_transposed(vector_type &rhs) const
+        {
+            for (size_type i = 0; i < N; i++)
+            {
+                value_type sum = rhs[i];
+                for (size_type j = 0; j < i; j++)
+                    sum -= lu_[j][i] * rhs[j];
+                rhs[i] = sum / lu_[i][i];
+            }
+            for (size_type i = N; i-- > 0;)
+            {
+                value_type sum = rhs[i];
+                for (size_type j = i + 1; j < N; j++)
+                    sum -= lu_[j][i] * rhs[j];
+                rhs[i] = sum;
+            }
+            for (size_type k = N; k-- > 0;)
+            {
+                if (piv_[k] != k)
+                    std::swap(rhs[k], rhs[piv_[k]]);
+            }
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,252 @@
+#ifndef SPARSELU_HPP
+#define SPARSELU_HPP
+/*
+    LU factorization of a CsrMatrix without pivoting, rows and columns symmetrically reordered by reverse Cuthill-McKee.
+    Ordering and pattern of factors (including fill) are computed once per matrix pattern, every further
+    factorization only recomputes values, so Newton iterations with a fixed jacobian pattern cost O(fill).
+    Without pivoting it is meant for matrices with dominant diagonal, such as dT * J - I of implicit schemes.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "csrMatrix.hpp"
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+SmallLU
+    member functions:
+        void factorize(const matrix_type &matrix)
+        void solve(vector_type &rhs) const               rhs is overwritten by solution of A x = rhs
+        void solve_transposed(vector_type &rhs) const    rhs is overwritten by solution of A^T x = rhs
+    */
+    template <typename Type, typename SizeType = std::size_t>
+    class SparseLU
+    {
+    public:
+        typedef Type value_type;
+        typedef SizeType size_type;
+
+    private:
+        size_type n_;
+        std::vector<size_type> analyzed_start_, analyzed_columns_; // pattern the factors were analyzed for
+        std::vector<size_type> perm_, inverse_;          // perm_[new index] = old index
+        std::vector<size_type> row_start_, columns_, diag_; // factors in CSR, unit L below diag_, U from diag_
+        std::vector<value_type> values_;
+        std::vector<size_type> map_;                     // position in values_ of every entry of the matrix
+        mutable std::vector<value_type> work_;
+
+    public:
+        SparseLU() : n_(0){};
+        ~SparseLU(){};
+
+    public:
+        size_type nnz() const { return columns_.size(); }
+
+        void factorize(const CsrMatrix<value_type, size_type> &matrix)
+        {
+            // same size and nnz do not imply same pattern, map_ would scatter values to wrong places
+            if (matrix.size1() != n_ || matrix.row_start() != analyzed_start_ || matrix.columns() != analyzed_columns_)
+                analyze(matrix);
+
+            std::fill(values_.begin(), values_.end(), 0.0);
+            for (size_type e = 0; e < matrix.nnz(); e++)
+                values_[map_[e]] += matrix.values()[e];
+
+            // row by row elimination, row i is scattered to work_ and reduced by rows above it
+            for (size_type i = 0; i < n_; i++)
+            {
+                for (size_type p = row_start_[i]; p < row_start_[i + 1]; p++)
+                    work_[columns_[p]] = values_[p];
+                for (size_type p = row_start_[i]; p < diag_[i]; p++)
+                {
+                    const size_type k = columns_[p];
+                    // singular matrix gives inf/nan, which callers detect on the solution
+                    const value_type l = work_[k] / values_[diag_[k]];
+                    work_[k] = l;
+                    for (size_type q = diag_[k] + 1; q < row_start_[k + 1]; q++)
+                        work_[columns_[q]] -= l * values_[q];
+                }
+                for (size_type p = row_start_[i]; p < row_start_[i + 1]; p++)
+                    values_[p] = work_[columns_[p]];
+            }
+        }
+
+        template <typename vector_type>
+        void solve(vector_type &rhs) const
+        {
+            assert((size_type)rhs.size() == n_);
+            for (size_type i = 0; i < n_; i++)
+                work_[i] = rhs[perm_[i]];
+            for (size_type i = 0; i < n_; i++)
+            {
+                value_type sum = work_[i];
+                for (size_type p = row_start_[i]; p < diag_[i]; p++)
+                    sum -= values_[p] * work_[columns_[p]];
+                work_[i] = sum;
+            }
+            for (size_type i = n_; i-- > 0;)
+            {
+                value_type sum = work_[i];
+                for (size_type p = diag_[i] + 1; p < row_start_[i + 1]; p++)
+                    sum -= values_[p] * work_[columns_[p]];
+                work_[i] = sum / values_[diag_[i]];
+            }
+            for (size_type i = 0; i < n_; i++)
+                rhs[perm_[i]] = work_[i];
+        }
+
+        // A^T = P^T U^T L^T P, rows of factors are used as columns
+        template <typename vector_type>
+        void solve_transposed(vector_type &rhs) const
+        {
+            assert((size_type)rhs.size() == n_);
+            for (size_type i = 0; i < n_; i++)
+                work_[i] = rhs[perm_[i]];
+            for (size_type i = 0; i < n_; i++)
+            {
+                work_[i] /= values_[diag_[i]];
+                for (size_type p = diag_[i] + 1; p < row_start_[i + 1]; p++)
+                    work_[columns_[p]] -= values_[p] * work_[i];
+            }
+            for (size_type i = n_; i-- > 0;)
+            {
+                for (size_type p = row_start_[i]; p < diag_[i]; p++)
+                    work_[columns_[p]] -= values_[p] * work_[i];
+            }
+            for (size_type i = 0; i < n_; i++)
+                rhs[perm_[i]] = work_[i];
+        }
+
+    private:
+        // ordering, pattern of factors and map of matrix entries into it
+        void analyze(const CsrMatrix<value_type, size_type> &matrix)
+        {
+            n_ = matrix.size1();
+            analyzed_start_ = matrix.row_start();
+            analyzed_columns_ = matrix.columns();
+            const auto &start = matrix.row_start();
+            const auto &cols = matrix.columns();
+            reverse_cuthill_mckee(matrix);
+
+            // pattern of row i of L + U is the pattern of the reordered row and of the U rows of its L entries,
+            // L entries are taken in increasing order from a heap as fill may add new ones
+            row_start_.assign(1, 0);
+            columns_.clear();
+            diag_.assign(n_, 0);
+            std::vector<char> marked(n_, 0);
+            std::vector<size_type> row;
+            std::priority_queue<size_type, std::vector<size_type>, std::greater<size_type>> lower;
+            for (size_type i = 0; i < n_; i++)
+            {
+                row.clear();
+                const size_type old_i = perm_[i];
+                auto mark = [&](const size_type j) {
+                    if (marked[j])
+                        return;
+                    marked[j] = 1;
+                    row.push_back(j);
+                    if (j < i)
+                        lower.push(j);
+                };
+                mark(i);
+                for (size_type p = start[old_i]; p < start[old_i + 1]; p++)
+                    mark(inverse_[cols[p]]);
+                while (!lower.empty())
+                {
+                    const size_type k = lower.top();
+                    lower.pop();
+                    for (size_type q = diag_[k] + 1; q < row_start_[k + 1]; q++)
+                        mark(columns_[q]);
+                }
+                std::sort(row.begin(), row.end());
+                for (const auto j : row)
+                    marked[j] = 0;
+                diag_[i] = columns_.size() + (std::lower_bound(row.begin(), row.end(), i) - row.begin());
+                columns_.insert(columns_.end(), row.begin(), row.end());
+                row_start_.push_back(columns_.size());
+            }
+            values_.assign(columns_.size(), 0.0);
+            work_.assign(n_, 0.0);
+
+            map_.resize(matrix.nnz());
+            for (size_type old_i = 0; old_i < n_; old_i++)
+            {
+                const size_type i = inverse_[old_i];
+                for (size_type p = start[old_i]; p < start[old_i + 1]; p++)
+                {
+                    const auto begin = columns_.begin() + row_start_[i], end = columns_.begin() + row_start_[i + 1];
+                    map_[p] = std::lower_bound(begin, end, inverse_[cols[p]]) - columns_.begin();
+                }
+            }
+        }
+
+        // breadth first search of the symmetrized pattern from a node of minimal degree in every component,
+        // neighbours in increasing degree, reversed - keeps nonzeros (and fill) close to the diagonal
+        void reverse_cuthill_mckee(const CsrMatrix<value_type, size_type> &matrix)
+        {
+            std::vector<std::vector<size_type>> adjacency(n_);
+            for (size_type i = 0; i < n_; i++)
+            {
+                for (size_type p = matrix.row_start()[i]; p < matrix.row_start()[i + 1]; p++)
+                {
+                    const size_type j = matrix.columns()[p];
+                    if (i == j)
+                        continue;
+                    adjacency[i].push_back(j);
+                    adjacency[j].push_back(i);
+                }
+            }
+            for (auto &a : adjacency)
+            {
+                std::sort(a.begin(), a.end());
+                a.erase(std::unique(a.begin(), a.end()), a.end());
+            }
+            auto by_degree = [&adjacency](const size_type a, const size_type b) {
+                return adjacency[a].size() < adjacency[b].size() || (adjacency[a].size() == adjacency[b].size() && a < b);
+            };
+            std::vector<size_type> nodes(n_);
+            for (size_type i = 0; i < n_; i++)
+                nodes[i] = i;
+            std::sort(nodes.begin(), nodes.end(), by_degree);
+
+            perm_.clear();
+            std::vector<char> visited(n_, 0);
+            std::vector<size_type> neighbours;
+            for (const auto root : nodes)
+            {
+                if (visited[root])
+                    continue;
+                visited[root] = 1;
+                size_type head = perm_.size();
+                perm_.push_back(root);
+                while (head < perm_.size())
+                {
+                    const size_type node = perm_[head++];
+                    neighbours.clear();
+                    for (const auto j : adjacency[node])
+                    {
+                        if (!visited[j])
+                        {
+                            visited[j] = 1;
+                            neighbours.push_back(j);
+                        }
+                    }
+                    std::sort(neighbours.begin(), neighbours.end(), by_degree);
+                    perm_.insert(perm_.end(), neighbours.begin(), neighbours.end());
+                }
+            }
+            std::reverse(perm_.begin(), perm_.end());
+            inverse_.resize(n_);
+            for (size_type i = 0; i < n_; i++)
+                inverse_[perm_[i]] = i;
+        }
+    };
+} // namespace ode
+#endif
@@ -0,0 +1,71 @@
+#ifndef STATETYPE_HPP
+#define STATETYPE_HPP
+/*
+    Fixed size vector and matrix types keyed on OdeSystem::dim.
+    Small ones keep storage inside the owning object (or on stack), so schemes using them never touch the heap.
+    Above max_inline_size values storage is on heap, allocated once when the owner is constructed,
+    so large systems (e.g. metapopulation) do not put dim or dim x dim arrays on the stack.
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+namespace ublas = boost::numeric::ublas;
+
+namespace ode
+{
+    // largest number of values stored inline, 8 kB of doubles
+    static const std::size_t constexpr max_inline_size = 1024;
+
+    // ublas::vector default constructed with Dim elements, drop-in replacement of c_vector for large Dim
+    template <typename Type, std::size_t Dim>
+    class heap_vector : public ublas::vector<Type>
+    {
+    private:
+        typedef ublas::vector<Type> base;
+
+    public:
+        heap_vector() : base(Dim){};
+        explicit heap_vector(const typename base::size_type size) : base(size) { assert(size == Dim); };
+        template <typename AE>
+        heap_vector(const ublas::vector_expression<AE> &ae) : base(ae){};
+
+        using base::operator=;
+    };
+
+    // ublas::matrix default constructed with Size1 x Size2 elements, drop-in replacement of c_matrix for large sizes
+    template <typename Type, std::size_t Size1, std::size_t Size2>
+    class heap_matrix : public ublas::matrix<Type>
+    {
+    private:
+        typedef ublas::matrix<Type> base;
+
+    public:
+        heap_matrix() : base(Size1, Size2){};
+        heap_matrix(const typename base::size_type size1, const typename base::size_type size2) : base(size1, size2)
+        {
+            assert(size1 == Size1 && size2 == Size2);
+        };
+        template <typename AE>
+        heap_matrix(const ublas::matrix_expression<AE> &ae) : base(ae){};
+
+        using base::operator=;
+    };
+
+    template <typename Type, std::size_t Dim>
+    using small_vector = std::conditional_t<(Dim <= max_inline_size), ublas::c_vector<Type, Dim>, heap_vector<Type, Dim>>;
+
+    template <typename Type, std::size_t Size1, std::size_t Size2>
+    using small_matrix = std::conditional_t<(Size1 * Size2 <= max_inline_size), ublas::c_matrix<Type, Size1, Size2>,
+                                            heap_matrix<Type, Size1, Size2>>;
+
+    template <typename OdeSystem>
+    using state_type = small_vector<typename OdeSystem::value_type, OdeSystem::dim>;
+
+    template <typename OdeSystem>
+    using jacobian_type = small_matrix<typename OdeSystem::value_type, OdeSystem::dim, OdeSystem::dim>;
+} // namespace ode
+#endif
@@ -0,0 +1,174 @@
+#ifndef TRBDF2_HPP
+#define TRBDF2_HPP
+/*
+    TR-BDF2 method, L-stable second order one step method for stiff systems (Bank et al. 1985).
+    Trapezoidal stage to t + gamma*dT is followed by BDF2 stage through y_n, stage and y_n+1.
+    With gamma = 2 - sqrt(2) both implicit equations have iteration matrix (d*dT*J - I), d = gamma/2,
+    so simplified Newton factorizes once per step (or less) and solves both stages with it.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "stateType.hpp"
+#include "jacobianStructure.hpp"
+#include "newtonSolver.hpp"
+
+namespace ode
+{
+    /*
+    Satisfies concepts:
+SchemeType
+    constructor:
+        SchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type
+    member functions:
+        void time_step(const OdeSystem &system, const vector_type &old_time, vector_type &new_time)
+    static variables:
+        size_type dim, order
+        char[] method_name
+
+AdjointSchemeType (SchemeType with discrete adjoint)
+    member functions:
+        void adjoint_step(const OdeSystem &system, const vector_type &old_time, const vector_type &new_time,
+                          vector_type &adjoint, vector_type &gradient)
+
+
+    Uses concepts:
+OdeSystem
+    member types:
+        size_type, value_type
+    member functions:
+        vector_type initial_condition() const
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &output_matrix )           output_matrix is newton_matrix<OdeSystem>::matrix_type,
+                                                               not used with matrix_free, jacobian_type<OdeSystem>
+                                                               in adjoint_step
+        void parameter_jacobian()( variables, &output_matrix ) (adjoint_step only, not with matrix_free)
+    member types:
+        jacobian_structure (optional)
+    static variables:
+        size_type dim
+        size_type no_params (adjoint_step only)
+*/
+
+    template <typename OdeSystem, typename NewtonType = full_newton,
+              typename Structure = typename jacobian_structure<OdeSystem>::type>
+    class TrBdf2
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename OdeSystem::value_type>::value,
+                                        typename OdeSystem::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename OdeSystem::size_type>::value,
+                                        typename OdeSystem::size_type>::type size_type;
+
+    private:
+        value_type dT_;
+        state_type<OdeSystem> stage_, base_, rhs_, temp_;
+        NewtonSolver<OdeSystem, NewtonType, Structure> newton_;
+
+        // method coefficients, stage_ = y_n + d*dT (f(y_n) + f(stage_)),
+        // y_n+1 = stage_weight * stage_ - old_weight * y_n + d*dT f(y_n+1)
+        static constexpr value_type gamma = 2.0 - M_SQRT2;
+        static constexpr value_type d = 1.0 - M_SQRT1_2;
+        static constexpr value_type stage_weight = (M_SQRT2 + 1.0) / 2.0;
+        static constexpr value_type old_weight = (M_SQRT2 - 1.0) / 2.0;
+
+    public:
+        static const char constexpr method_name[] = "trbdf2";
+        static const size_type constexpr dim = OdeSystem::dim;
+        static const size_type constexpr order = 2;
+
+    public:
+        TrBdf2(){};
+        TrBdf2(const value_type steps, const value_type final_time)
+            : dT_(final_time / steps), stage_(dim), base_(dim), rhs_(dim), temp_(dim){};
+        ~TrBdf2(){};
+
+    public:
+        template <typename v1, typename v2>
+        void time_step(const OdeSystem &system, const v1 &old_time, v2 &new_time)
+        {
+            assert((decltype(dim))old_time.size() == dim);
+            assert((decltype(new_time.size()))old_time.size() == new_time.size());
+#ifdef DMETHODS
+            std::cout << "Old time: " << old_time << std::endl;
+#endif
+            const bool stage_converged = trapezoidal_stage(system, old_time);
+
+            // BDF2 stage starts from linear extrapolation of y_n and stage_
+            base_.assign(stage_weight * stage_ - old_weight * old_time);
+            new_time.assign(old_time + (1.0 / gamma) * (stage_ - old_time));
+            // step without converged newton iteration in either stage is nan, as in EulerBackward
+            if (!newton_.converged(newton_.solve(system, base_, d * dT_, new_time)) || !stage_converged)
+            {
+                std::fill(new_time.begin(), new_time.end(), std::numeric_limits<value_type>::quiet_NaN());
+            }
+#ifdef DMETHODS
+            std::cout << "New time: " << new_time << std::endl;
+#endif
+        }
+
+        // adjoint holds dL/dx of new_time on input and dL/dx of old_time on output, dL/dp is added to gradient,
+        // stage is recomputed, mu_1 = (I - d dT J(y_n+1))^-T adjoint, mu_s = (I - d dT J(stage))^-T stage_weight mu_1,
+        // adjoint = -old_weight mu_1 + (I + d dT J(y_n))^T mu_s
+        template <typename v1, typename v2, typename v3, typename v4>
+        void adjoint_step(const OdeSystem &system, const v1 &old_time, const v2 &new_time, v3 &adjoint, v4 &gradient)
+        {
+            assert(old_time.size() == dim);
+            assert(new_time.size() == dim);
+            assert(adjoint.size() == dim);
+            assert(gradient.size() == OdeSystem::no_params);
+            static_assert(!std::is_same<Structure, matrix_free>::value, "discrete adjoint needs jacobian of OdeSystem");
+            jacobian_type<OdeSystem> jac;
+            small_matrix<value_type, dim, OdeSystem::no_params> param_jac;
+            state_type<OdeSystem> mu(dim);
+            const value_type a = d * dT_;
+
+            trapezoidal_stage(system, old_time);
+
+            // BDF2 stage, newton_ factorizes (a*J - I)
+            newton_.factorize(system, new_time, a, false);
+            mu.assign(-adjoint);
+            newton_.lu().solve_transposed(mu);
+            system.parameter_jacobian(new_time, param_jac);
+            noalias(gradient) += a * ublas::prod(ublas::trans(param_jac), mu);
+
+            // trapezoidal stage
+            newton_.factorize(system, stage_, a, false);
+            temp_.assign(-stage_weight * mu);
+            newton_.lu().solve_transposed(temp_);
+            system.parameter_jacobian(stage_, param_jac);
+            noalias(gradient) += a * ublas::prod(ublas::trans(param_jac), temp_);
+            system.parameter_jacobian(old_time, param_jac);
+            noalias(gradient) += a * ublas::prod(ublas::trans(param_jac), temp_);
+
+            system.jacobian(old_time, jac);
+            adjoint.assign(temp_ - old_weight * mu + a * ublas::prod(ublas::trans(jac), temp_));
+        }
+
+    private:
+        // stage_ at t + gamma*dT, simplified newton starts from explicit euler predictor, false if newton did not converge
+        template <typename vector_type>
+        bool trapezoidal_stage(const OdeSystem &system, const vector_type &old_time)
+        {
+            system(old_time, rhs_);
+            base_.assign(old_time + (d * dT_) * rhs_);
+            if (newton_.simplified)
+                stage_.assign(old_time + (gamma * dT_) * rhs_);
+            else
+                stage_.assign(old_time);
+            return newton_.converged(newton_.solve(system, base_, d * dT_, stage_));
+        }
+    };
+} // namespace ode
+#endif
@@ -10,6 +10,7 @@
 namespace ublas = boost::numeric::ublas;
 
 #include "lineSearch.hpp"
+#include "report.hpp"
 
 namespace optimization
 {
@@ -34,7 +35,8 @@ target_functor
     BFGS(target_functor &target_fun,
          const vector_type &starting_variables,
          const scalar_type tolerance,
-         matrix_type hessian = ublas::identity_matrix<typename target_functor::value_type>(target_functor::dim)) //copy of hessian matrix is on purpose
+         matrix_type hessian = ublas::identity_matrix<typename target_functor::value_type>(target_functor::dim), //copy of hessian matrix is on purpose
+         Report *report = nullptr)
     {
 #ifdef DLVL1
         std::cout << "Starting BFGS" << std::endl;
@@ -135,6 +137,11 @@ target_functor
                       << std::endl;
         }
 
+        if (report)
+        {
+            report->iterations = k;
+            report->converged = converged;
+        }
         return variables;
     };
 
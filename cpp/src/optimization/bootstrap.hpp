@@ -0,0 +1,129 @@
+#ifndef BOOTSTRAP_HPP
+#define BOOTSTRAP_HPP
+/*
+    Bootstrap of a fit to a time series - residuals of the fit are resampled (single days or moving blocks of days),
+    added to the fitted series and every replicate is fitted again, in parallel.
+    Percentiles of the refitted variables give confidence intervals.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "../parallel/threadPool.hpp"
+
+namespace optimization
+{
+    // replicate = fitted + residuals of randomly chosen blocks of block_length consecutive columns,
+    // column 0 (initial condition) is kept, block_length 1 resamples single columns independently
+    template <typename matrix_type, typename rng_type>
+    void resample_residuals(const matrix_type &fitted, const matrix_type &residuals, matrix_type &replicate,
+                            const typename matrix_type::size_type block_length, rng_type &rng)
+    {
+        typedef typename matrix_type::size_type size_type;
+        const size_type no_columns = fitted.size2();
+        assert(residuals.size1() == fitted.size1() && residuals.size2() == no_columns);
+        assert(replicate.size1() == fitted.size1() && replicate.size2() == no_columns);
+        assert(block_length > 0 && block_length < no_columns);
+
+        ublas::column(replicate, 0).assign(ublas::column(fitted, 0));
+        std::uniform_int_distribution<size_type> block_start(1, no_columns - block_length);
+        for (size_type j = 1; j < no_columns;)
+        {
+            const size_type start = block_start(rng);
+            for (size_type b = 0; b < block_length && j < no_columns; b++, j++)
+                ublas::column(replicate, j).assign(ublas::column(fitted, j) + ublas::column(residuals, start + b));
+        }
+    }
+
+    // linear interpolation between order statistics of sorted values, q in [0, 1]
+    template <typename iterator_type>
+    typename std::iterator_traits<iterator_type>::value_type percentile(iterator_type begin, iterator_type end, const double q)
+    {
+        assert(begin != end && q >= 0.0 && q <= 1.0);
+        const double position = q * (std::distance(begin, end) - 1);
+        const auto below = (typename std::iterator_traits<iterator_type>::difference_type)std::floor(position);
+        if (begin + below + 1 == end)
+            return *(begin + below);
+        return *(begin + below) + (position - below) * (*(begin + below + 1) - *(begin + below));
+    }
+
+    template <typename Type>
+    struct BootstrapResult
+    {
+        typedef Type value_type;
+        typedef typename ublas::vector<value_type>::size_type size_type;
+
+        ublas::vector<value_type> estimate;                        // fit to original data
+        ublas::matrix<value_type, ublas::column_major> replicates; // one column of refitted variables per replicate
+        ublas::vector<value_type> targets;                         // target value of each refit
+        std::vector<char> converged;                               // whether each refit converged
+        ublas::vector<value_type> median, lower, upper;            // percentile interval per variable
+        value_type confidence;                                     // level of the intervals
+
+        BootstrapResult(const size_type dim, const size_type no_replicates)
+            : estimate(dim), replicates(dim, no_replicates), targets(no_replicates), converged(no_replicates, 0),
+              median(dim), lower(dim), upper(dim), confidence(0.95){};
+
+        size_type no_converged() const { return std::count(converged.begin(), converged.end(), 1); }
+    };
+
+    /*
+////Uses concepts:
+refit_functor
+    member functions:
+        value_type operator()(size_type replicate, vector_type &estimate, bool &converged, size_type worker_index)
+            builds replicate data, fits it, returns target value at estimate,
+            calls with distinct worker_index may run concurrently
+    */
+    // refits every replicate on pool, then fills percentile intervals of result (at level result.confidence)
+    // from converged refits with finite target
+    template <typename value_type, typename refit_functor>
+    void bootstrap(parallel::ThreadPool &pool, BootstrapResult<value_type> &result, refit_functor &refit)
+    {
+        typedef typename BootstrapResult<value_type>::size_type size_type;
+        const size_type dim = result.replicates.size1();
+        const size_type no_replicates = result.replicates.size2();
+        assert(no_replicates > 0);
+
+        auto task = [&result, &refit, dim](const size_type replicate, const size_type worker) {
+            ublas::vector<value_type> estimate(dim);
+            bool converged = false;
+            result.targets[replicate] = refit(replicate, estimate, converged, worker);
+            result.converged[replicate] = converged && std::isfinite(result.targets[replicate]);
+            ublas::column(result.replicates, replicate).assign(estimate);
+        };
+        pool.run(no_replicates, task);
+
+        const value_type tail = (1.0 - result.confidence) / 2;
+        std::vector<value_type> values;
+        values.reserve(no_replicates);
+        for (size_type i = 0; i < dim; i++)
+        {
+            values.clear();
+            for (size_type j = 0; j < no_replicates; j++)
+            {
+                if (result.converged[j])
+                    values.push_back(result.replicates(i, j));
+            }
+            if (values.empty())
+            {
+                result.median[i] = result.lower[i] = result.upper[i] = std::nan("");
+                continue;
+            }
+            std::sort(values.begin(), values.end());
+            result.median[i] = percentile(values.begin(), values.end(), 0.5);
+            result.lower[i] = percentile(values.begin(), values.end(), tail);
+            result.upper[i] = percentile(values.begin(), values.end(), 1.0 - tail);
+        }
+    }
+} // namespace optimization
+#endif
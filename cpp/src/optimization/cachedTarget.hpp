@@ -0,0 +1,161 @@
+#ifndef CACHEDTARGET_HPP
+#define CACHEDTARGET_HPP
+/*
+    Wrapper of a target function remembering its values and gradients at the last few points.
+    Points are matched bitwise, so optimizers asking again for the accepted line search point get it for free.
+*/
+
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "lineSearch.hpp"
+
+namespace optimization
+{
+    /*
+////Satisfies concepts:
+target_functor
+    member types:
+        size_type, value_type
+    member functions:
+        value_type target_fun(const& variables_vector)
+        void gradient(const& variables_vector, const& value_type, & gradient_vect_out)
+        bool bounded(const& variables_vector, value_type bound, & value_type value_out) (if target_functor has it)
+    static variables:
+        size_type dim
+
+
+////Uses concepts:
+target_functor
+    */
+    template <typename target_functor, std::size_t Size = 4>
+    class CachedTarget
+    {
+    public:
+        typedef typename target_functor::value_type value_type;
+        typedef typename target_functor::size_type size_type;
+
+    public:
+        const static size_type constexpr dim = target_functor::dim;
+
+    private:
+        typedef ublas::c_vector<value_type, dim> vector_type;
+
+        struct entry
+        {
+            vector_type key_, gradient_;
+            value_type value_;
+            bool has_value_, has_gradient_;
+        };
+
+    private:
+        target_functor &target_;
+        entry entries_[Size];
+        size_type next_; // slot replaced by the next new point
+
+    public:
+        CachedTarget(target_functor &target) : target_(target), next_(0)
+        {
+            for (auto &e : entries_)
+            {
+                e.has_value_ = e.has_gradient_ = false;
+            }
+        };
+        ~CachedTarget(){};
+
+    public:
+        template <typename vect>
+        value_type operator()(vect const &p)
+        {
+            assert(p.size() == dim);
+            entry *e = find(p);
+            if (!e)
+                e = &insert(p);
+            if (!e->has_value_)
+            {
+                e->value_ = target_(p);
+                e->has_value_ = true;
+            }
+            return e->value_;
+        }
+
+        // only values within bound are stored, partial sums of exceeded evaluations are not
+        template <typename vect, typename T = target_functor>
+        typename std::enable_if<has_bounded_evaluation<T, vect>::value, bool>::type
+        bounded(vect const &p, const value_type bound, value_type &value)
+        {
+            assert(p.size() == dim);
+            entry *e = find(p);
+            if (e && e->has_value_)
+            {
+                value = e->value_;
+                return value <= bound;
+            }
+            const bool within = target_.bounded(p, bound, value);
+            if (within)
+            {
+                if (!e)
+                    e = &insert(p);
+                e->value_ = value;
+                e->has_value_ = true;
+            }
+            return within;
+        }
+
+        template <typename v1, typename v2>
+        void gradient(v1 const &p, const value_type target_value, v2 &grad)
+        {
+            assert(p.size() == dim);
+            assert(grad.size() == dim);
+            entry *e = find(p);
+            if (!e)
+                e = &insert(p);
+            if (!e->has_gradient_)
+            {
+                target_.gradient(p, target_value, e->gradient_);
+                e->has_gradient_ = true;
+            }
+            grad.assign(e->gradient_);
+        }
+
+    private:
+        template <typename vect>
+        entry *find(vect const &p)
+        {
+            for (auto &e : entries_)
+            {
+                if ((e.has_value_ || e.has_gradient_) && same_bits(e.key_, p))
+                    return &e;
+            }
+            return nullptr;
+        }
+
+        // new empty entry of point p, replaces the oldest one
+        template <typename vect>
+        entry &insert(vect const &p)
+        {
+            entry &e = entries_[next_];
+            next_ = (next_ + 1) % Size;
+            e.key_.assign(p);
+            e.has_value_ = e.has_gradient_ = false;
+            return e;
+        }
+
+        template <typename vect>
+        static bool same_bits(const vector_type &key, vect const &p)
+        {
+            for (size_type i = 0; i < dim; i++)
+            {
+                const value_type x = p[i];
+                if (std::memcmp(&key[i], &x, sizeof(value_type)) != 0)
+                    return false;
+            }
+            return true;
+        }
+    };
+} // namespace optimization
+#endif
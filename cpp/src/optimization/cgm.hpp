@@ -13,6 +13,7 @@
 namespace ublas = boost::numeric::ublas;
 
 #include "lineSearch.hpp"
+#include "report.hpp"
 
 namespace optimization
 {
@@ -63,7 +64,7 @@ target_functor
                                 std::is_integral<typename target_functor::size_type>::value &&
                                 std::is_arithmetic<scalar_type>::value,
                             vector_type>::type
-    CGM(target_functor &target_fun, const vector_type &starting_variables, const scalar_type tolerance)
+    CGM(target_functor &target_fun, const vector_type &starting_variables, const scalar_type tolerance, Report *report = nullptr)
     {
 #ifdef DLVL1
         std::cout << "Starting CGM" << std::endl;
@@ -160,6 +161,11 @@ target_functor
                       << std::endl;
         }
 
+        if (report)
+        {
+            report->iterations = k;
+            report->converged = converged;
+        }
         return variables;
     }
 
@@ -0,0 +1,237 @@
+#ifndef LBFGSB_HPP
+#define LBFGSB_HPP
+/*
+    Projected limited memory BFGS for box constrained problems (lower <= variables <= upper).
+    Variables at a bound with gradient pushing outwards are held fixed, the quasi-Newton direction
+    of the remaining ones comes from the last Memory steps (two-loop recursion), and the line search
+    backtracks along the path projected onto the box, so the target is never evaluated outside of it.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/io.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "lineSearch.hpp"
+#include "report.hpp"
+#include "../profiling/counters.hpp"
+
+namespace optimization
+{
+    /*
+////Uses concepts:
+target_functor
+    member types:
+        size_type, value_type
+    member functions:
+        value_type target_fun(const& variables_vector)
+        void gradient(const& variables_vector, const& value_type, & gradient_vect_out)
+        bool bounded(const& variables_vector, value_type bound, & value_type value_out) (optional)
+    static variables:
+        size_type dim
+    */
+    // infinite bounds leave variables unconstrained on that side
+    template <std::size_t Memory = 8, typename target_functor, typename vector_type, typename scalar_type>
+    typename std::enable_if<std::is_floating_point<typename target_functor::value_type>::value &&
+                                std::is_integral<typename target_functor::size_type>::value &&
+                                std::is_arithmetic<scalar_type>::value,
+                            vector_type>::type
+    LBFGSB(target_functor &target_fun, const vector_type &starting_variables, const vector_type &lower,
+           const vector_type &upper, const scalar_type tolerance, Report *report = nullptr)
+    {
+#ifdef DLVL1
+        std::cout << "Starting L-BFGS-B" << std::endl;
+#endif
+        typedef typename target_functor::value_type value_type;
+        typedef typename target_functor::size_type size_type;
+        typedef ublas::c_vector<value_type, target_functor::dim> small_vector;
+        const static size_type constexpr dim = target_functor::dim;
+
+        assert((size_type)starting_variables.size() == dim);
+        assert((size_type)lower.size() == dim && (size_type)upper.size() == dim);
+        const size_type max_iters = 1000;
+        const size_type max_backtracks = 100;
+        const value_type max_step_size = 1.0;
+        const value_type C1 = 1e-4;
+
+        // ring buffer of last steps s, gradient changes y and 1 / (s^T y)
+        small_vector s[Memory], y[Memory];
+        value_type rho[Memory], alpha[Memory];
+        size_type no_pairs = 0, newest = Memory - 1;
+
+        bool converged = false, line_search_failed = false;
+        vector_type variables(dim), trial(dim), gradient(dim), trial_gradient(dim);
+        small_vector direction;
+        bool active[dim];
+
+        auto project = [&lower, &upper](vector_type &v) {
+            for (size_type i = 0; i < dim; i++)
+                v[i] = std::min(std::max(v[i], lower[i]), upper[i]);
+        };
+
+        variables.assign(starting_variables);
+        project(variables);
+        value_type target = target_fun(variables);
+        target_fun.gradient(variables, target, gradient);
+
+        size_type k;
+        for (k = 0; k < max_iters; k++)
+        {
+#ifdef DLVL2
+            std::cout << "L-BFGS-B, iteration " << k << ", variables: " << variables << std::endl
+                      << "gradient: " << gradient << std::endl
+                      << "Target value: " << target << std::endl;
+#endif
+            // variables held at bounds, the others are free
+            size_type no_free = 0;
+            for (size_type i = 0; i < dim; i++)
+            {
+                active[i] = (variables[i] <= lower[i] && gradient[i] > 0.0) || (variables[i] >= upper[i] && gradient[i] < 0.0);
+                no_free += !active[i];
+            }
+            if (no_free == 0)
+            {
+                converged = true;
+                break;
+            }
+
+            // two-loop recursion on free variables, initial hessian scaled by last curvature
+            for (size_type i = 0; i < dim; i++)
+                direction[i] = active[i] ? 0.0 : gradient[i];
+            for (size_type j = 0, m = newest; j < no_pairs; j++, m = (m + Memory - 1) % Memory)
+            {
+                alpha[m] = rho[m] * ublas::inner_prod(s[m], direction);
+                noalias(direction) -= alpha[m] * y[m];
+            }
+            if (no_pairs > 0)
+                direction *= ublas::inner_prod(s[newest], y[newest]) / ublas::inner_prod(y[newest], y[newest]);
+            for (size_type j = 0, m = (newest + Memory + 1 - no_pairs) % Memory; j < no_pairs; j++, m = (m + 1) % Memory)
+            {
+                const value_type beta = rho[m] * ublas::inner_prod(y[m], direction);
+                noalias(direction) += (alpha[m] - beta) * s[m];
+            }
+            direction *= -1.0;
+            value_type slope = 0.0;
+            for (size_type i = 0; i < dim; i++)
+            {
+                if (active[i])
+                    direction[i] = 0.0;
+                slope += direction[i] * gradient[i];
+            }
+            // memory no longer describes the free subspace, restart from steepest descent
+            if (!(slope < 0.0))
+            {
+                no_pairs = 0;
+                for (size_type i = 0; i < dim; i++)
+                    direction[i] = active[i] ? 0.0 : -gradient[i];
+            }
+
+            // backtracking on the projected path with sufficient decrease along the projected step,
+            // steps below tolerance cannot change the result
+            value_type step_size = max_step_size, trial_target = target;
+            const value_type min_step_size = tolerance * ublas::norm_2(variables) / ublas::norm_2(direction);
+            bool accepted = false, stationary = false;
+            size_type b;
+            for (b = 0; b < max_backtracks && step_size >= min_step_size; b++)
+            {
+                trial.assign(variables + step_size * direction);
+                project(trial);
+                const value_type decrease = ublas::inner_prod(gradient, trial - variables);
+                if (!(decrease < 0.0))
+                {
+                    stationary = true; // projected path does not descend, box constrained optimum
+                    break;
+                }
+                if (within_bound(target_fun, trial, target + C1 * decrease, trial_target))
+                {
+                    accepted = true;
+                    break;
+                }
+                step_size /= 2;
+                profiling::count(profiling::Event::line_search_backtrack);
+            }
+            profiling::count(profiling::Event::line_search);
+#ifdef DLVL1
+            std::cout << "\tChosen step size in " << b << " iterations: " << step_size << std::endl;
+#endif
+
+            //convergence check, same measure as BFGS
+            const value_type res = ublas::norm_2(trial - variables) / ublas::norm_2(variables);
+            if (!accepted && no_pairs > 0)
+            {
+                no_pairs = 0; // failed quasi-Newton direction, retry from steepest descent
+                continue;
+            }
+            // no decrease along steepest descent of free variables: at optimum within tolerance if steps
+            // shrank below it with finite target, otherwise backtracking ran out or target evaluation failed
+            if (!accepted)
+            {
+                line_search_failed = !stationary && (b == max_backtracks || !std::isfinite(trial_target));
+                converged = !line_search_failed;
+                break;
+            }
+            if (res < tolerance)
+            {
+                converged = true;
+                variables.assign(trial);
+                break;
+            }
+
+            target_fun.gradient(trial, trial_target, trial_gradient);
+            const size_type next = (newest + 1) % Memory;
+            s[next].assign(trial - variables);
+            y[next].assign(trial_gradient - gradient);
+            const value_type sy = ublas::inner_prod(s[next], y[next]);
+            // pairs violating curvature condition would break positive definiteness
+            if (sy > std::numeric_limits<value_type>::epsilon() * ublas::norm_2(s[next]) * ublas::norm_2(y[next]))
+            {
+                rho[next] = 1.0 / sy;
+                newest = next;
+                no_pairs = std::min(no_pairs + 1, (size_type)Memory);
+            }
+            variables.assign(trial);
+            gradient.assign(trial_gradient);
+            target = trial_target;
+#ifdef DLVL1
+            std::cout << "L-BFGS-B residual in step_size " << k << ": " << res << std::endl;
+#endif
+        }
+        if (converged)
+        {
+#ifndef NINFO
+            std::cout << "L-BFGS-B converged in " << k << " iterations. " << std::endl
+                      << "Final variables:" << variables << std::endl;
+#endif
+        }
+        else if (line_search_failed)
+        {
+            std::cerr << std::endl
+                      << "L-BFGS-B line search found no decrease in iteration " << k << "!" << std::endl
+                      << "Variables are:" << variables << std::endl
+                      << std::endl;
+        }
+        else
+        {
+            std::cerr << std::endl
+                      << "L-BFGS-B did NOT converge in iteration limit(" << max_iters << ")!" << std::endl
+                      << "Variables are:" << variables << std::endl
+                      << std::endl;
+        }
+
+        if (report)
+        {
+            report->iterations = k;
+            report->converged = converged;
+            report->line_search_failed = line_search_failed;
+        }
+        return variables;
+    };
+
+} // namespace optimization
+
+#endif
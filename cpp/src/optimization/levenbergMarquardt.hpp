@@ -0,0 +1,158 @@
+#ifndef LEVENBERGMARQUARDT_HPP
+#define LEVENBERGMARQUARDT_HPP
+/*
+    Levenberg-Marquardt algorithm minimizes squared norm of a residual vector.
+    Curvature comes from the residual jacobian (Gauss-Newton approximation J^T J), damped by mu * diag(J^T J),
+    so fitting problems converge in a few iterations, each needing one jacobian and one or more residual evaluations.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/io.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "report.hpp"
+#include "../ode/smallLU.hpp"
+
+namespace optimization
+{
+    /*
+////Uses concepts:
+residual_functor
+    member types:
+        size_type, value_type
+    member functions:
+        size_type no_residuals()
+        void residuals(const& variables_vector, & residual_vect_out)
+        void residual_jacobian(const& variables_vector, & residual_vect_out, & jacobian_matrix_out)
+    static variables:
+        size_type dim
+    */
+    template <typename residual_functor, typename vector_type, typename scalar_type>
+    typename std::enable_if<std::is_floating_point<typename residual_functor::value_type>::value &&
+                                std::is_integral<typename residual_functor::size_type>::value &&
+                                std::is_arithmetic<scalar_type>::value,
+                            vector_type>::type
+    LevenbergMarquardt(residual_functor &residual_fun, const vector_type &starting_variables, const scalar_type tolerance,
+                       Report *report = nullptr)
+    {
+#ifdef DLVL1
+        std::cout << "Starting Levenberg-Marquardt" << std::endl;
+#endif
+        typedef typename residual_functor::value_type value_type;
+        typedef typename residual_functor::size_type size_type;
+        const static size_type constexpr dim = residual_functor::dim;
+
+        assert((size_type)starting_variables.size() == dim);
+        const size_type no_residuals = residual_fun.no_residuals();
+        const size_type max_iters = 1000;
+        const value_type initial_damping = 1e-3; // relative to largest diagonal entry of J^T J
+
+        bool converged = false;
+        vector_type variables(starting_variables), trial(dim);
+        ublas::vector<value_type> residuals(no_residuals), trial_residuals(no_residuals);
+        ublas::matrix<value_type, ublas::column_major> jacobian(no_residuals, dim);
+        ublas::c_matrix<value_type, dim, dim> normal, damped;
+        ublas::c_vector<value_type, dim> gradient, step;
+        ode::SmallLU<value_type, dim> lu;
+
+        // half squared norms, predicted decrease of the damped model is step^T (mu D step - gradient) / 2
+        residual_fun.residual_jacobian(variables, residuals, jacobian);
+        value_type target = 0.5 * ublas::inner_prod(residuals, residuals);
+        noalias(normal) = ublas::prod(ublas::trans(jacobian), jacobian);
+        noalias(gradient) = ublas::prod(ublas::trans(jacobian), residuals);
+        value_type mu = 0.0, nu = 2.0;
+        for (size_type i = 0; i < dim; i++)
+            mu = std::max(mu, normal(i, i));
+        mu *= initial_damping;
+
+        size_type k;
+        for (k = 0; k < max_iters; k++)
+        {
+#ifdef DLVL2
+            std::cout << "LM, iteration " << k << ", variables: " << variables << std::endl
+                      << "gradient: " << gradient << std::endl
+                      << "Target value: " << 2.0 * target << ", damping: " << mu << std::endl;
+#endif
+            if (ublas::norm_inf(gradient) == 0.0)
+            {
+                converged = true;
+                break;
+            }
+
+            damped.assign(normal);
+            for (size_type i = 0; i < dim; i++)
+                damped(i, i) += mu * std::max(normal(i, i), std::numeric_limits<value_type>::min());
+            step.assign(-gradient);
+            lu.factorize(damped);
+            lu.solve(step);
+
+            //convergence check, same measure as BFGS
+            const value_type res = ublas::norm_2(step) / ublas::norm_2(variables);
+            if (res < tolerance)
+            {
+                converged = true;
+                break;
+            }
+
+            trial.assign(variables + step);
+            residual_fun.residuals(trial, trial_residuals);
+            const value_type trial_target = 0.5 * ublas::inner_prod(trial_residuals, trial_residuals);
+            value_type predicted = 0.0;
+            for (size_type i = 0; i < dim; i++)
+                predicted += step[i] * ((damped(i, i) - normal(i, i)) * step[i] - gradient[i]);
+            predicted *= 0.5;
+            const value_type rho = (target - trial_target) / predicted;
+
+            if (std::isfinite(trial_target) && rho > 0.0)
+            {
+                // accepted, damping decreases the better the model predicted the decrease
+                variables.assign(trial);
+                residual_fun.residual_jacobian(variables, residuals, jacobian);
+                target = 0.5 * ublas::inner_prod(residuals, residuals);
+                noalias(normal) = ublas::prod(ublas::trans(jacobian), jacobian);
+                noalias(gradient) = ublas::prod(ublas::trans(jacobian), residuals);
+                mu *= std::max((value_type)(1.0 / 3.0), 1 - std::pow(2 * rho - 1, 3));
+                nu = 2.0;
+            }
+            else
+            {
+                mu *= nu;
+                nu *= 2.0;
+            }
+#ifdef DLVL1
+            std::cout << "LM residual in step " << k << ": " << res << (rho > 0.0 ? "" : " (rejected)") << std::endl;
+#endif
+        }
+        if (converged)
+        {
+#ifndef NINFO
+            std::cout << "Levenberg-Marquardt converged in " << k << " iterations. " << std::endl
+                      << "Final variables:" << variables << std::endl;
+#endif
+        }
+        else
+        {
+            std::cerr << std::endl
+                      << "Levenberg-Marquardt did NOT converge in iteration limit(" << max_iters << ")!" << std::endl
+                      << "Variables are:" << variables << std::endl
+                      << std::endl;
+        }
+
+        if (report)
+        {
+            report->iterations = k;
+            report->converged = converged;
+        }
+        return variables;
+    };
+
+} // namespace optimization
+
+#endif
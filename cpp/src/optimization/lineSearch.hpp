@@ -5,13 +5,47 @@
 */
 
 #include <cassert>
+#include <type_traits>
+#include <utility>
 
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
 namespace ublas = boost::numeric::ublas;
 
+#include "../profiling/counters.hpp"
+
 namespace optimization
 {
+    // target_functor with bool bounded(variables, bound, value_out), which may stop evaluating once value exceeds bound
+    template <typename target_functor, typename vector_type, typename = void>
+    struct has_bounded_evaluation : std::false_type
+    {
+    };
+
+    template <typename target_functor, typename vector_type>
+    struct has_bounded_evaluation<target_functor, vector_type,
+                                  std::void_t<decltype(std::declval<target_functor &>().bounded(
+                                      std::declval<const vector_type &>(), std::declval<typename vector_type::value_type>(),
+                                      std::declval<typename vector_type::value_type &>()))>> : std::true_type
+    {
+    };
+
+    // target value at p and whether it is not above bound, evaluation may stop early if target supports it
+    template <typename target_functor, typename vector_type>
+    bool within_bound(target_functor &target, const vector_type &p, const typename vector_type::value_type bound,
+                      typename vector_type::value_type &value)
+    {
+        if constexpr (has_bounded_evaluation<target_functor, vector_type>::value)
+        {
+            return target.bounded(p, bound, value);
+        }
+        else
+        {
+            value = target(p);
+            return value <= bound;
+        }
+    }
+
     template <typename vector_type>
     class LineSearch
     {
@@ -41,6 +75,7 @@ target_functor
     member functions:
         value_type target_fun(const& variables_vector)
         void gradient(const& variables_vector, const& value_type, & gradient_vect_out)
+        bool bounded(const& variables_vector, value_type bound, & value_type value_out) (optional)
     static variables:
         size_type dim
     */
@@ -51,6 +86,7 @@ target_functor
         {
             assert(pk.size() == dk.size());
             assert(pk.size() == grad_target_k.size());
+            profiling::count(profiling::Event::line_search);
 
             const auto dk_grad_prod = ublas::inner_prod(dk, grad_target_k);
 
@@ -58,28 +94,38 @@ target_functor
             auto rhs1 = [target_k, dk_grad_prod](auto const step_size) { return target_k + C1 * step_size * dk_grad_prod; };
             const auto rhs2 = -C2 * dk_grad_prod;
 
-            p_step_ = pk + step_size * dk;
-            auto target_after_step = target(p_step_);
+            p_step_.assign(pk + step_size * dk);
+            value_type target_after_step;
 
             size_t i;
             for (i = 0; i < 100 && step_size > min_step_; i++)
             {
-                target.gradient(p_step_, target_after_step, gradient_);
-                // check Wolfe's conditions
-                if ((target_after_step <= rhs1(step_size)) &&
-                    ((-1.0) * ublas::inner_prod(dk, gradient_) <= rhs2))
+                // check Wolfe's conditions, gradient is needed only when the first one holds
+                if (sufficient_decrease(target, rhs1(step_size), target_after_step))
                 {
-                    break;
+                    target.gradient(p_step_, target_after_step, gradient_);
+                    if ((-1.0) * ublas::inner_prod(dk, gradient_) <= rhs2)
+                    {
+                        break;
+                    }
                 }
                 step_size = step_size / 2;
                 p_step_.assign(pk + step_size * dk);
-                target_after_step = target(p_step_);
+                profiling::count(profiling::Event::line_search_backtrack);
             }
 #ifdef DLVL1
             std::cout << "\tChosen step size in " << i << " iterations: " << step_size << std::endl;
 #endif
             return step_size;
         }
+
+    private:
+        // target value at p_step_ and whether it is not above bound
+        template <typename target_functor>
+        bool sufficient_decrease(target_functor &target, const value_type bound, value_type &target_after_step)
+        {
+            return within_bound(target, p_step_, bound, target_after_step);
+        }
     };
 
 } // namespace optimization
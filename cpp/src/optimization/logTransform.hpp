@@ -0,0 +1,112 @@
+#ifndef LOGTRANSFORM_HPP
+#define LOGTRANSFORM_HPP
+/*
+    Target function of logarithms of positive variables, p = exp(z).
+    Optimizing z keeps variables positive and treats relative changes of small and large variables alike,
+    which improves conditioning when they differ by orders of magnitude.
+*/
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "lineSearch.hpp"
+
+namespace optimization
+{
+    // elementwise logarithm, zero maps to -inf (an infinite bound stays infinite)
+    template <typename vector_type>
+    vector_type to_log(const vector_type &v)
+    {
+        vector_type ret(v.size());
+        for (decltype(v.size()) i = 0; i < v.size(); i++)
+            ret[i] = v[i] > 0.0 ? std::log(v[i]) : -std::numeric_limits<typename vector_type::value_type>::infinity();
+        return ret;
+    }
+
+    template <typename vector_type>
+    vector_type from_log(const vector_type &v)
+    {
+        vector_type ret(v.size());
+        for (decltype(v.size()) i = 0; i < v.size(); i++)
+            ret[i] = std::exp(v[i]);
+        return ret;
+    }
+
+    /*
+////Satisfies concepts:
+target_functor
+    member types:
+        size_type, value_type
+    member functions:
+        value_type target_fun(const& variables_vector)
+        void gradient(const& variables_vector, const& value_type, & gradient_vect_out)
+        bool bounded(const& variables_vector, value_type bound, & value_type value_out) (if target_functor has it)
+    static variables:
+        size_type dim
+
+
+////Uses concepts:
+target_functor
+    */
+    template <typename target_functor>
+    class LogTransform
+    {
+    public:
+        typedef typename target_functor::value_type value_type;
+        typedef typename target_functor::size_type size_type;
+
+    public:
+        const static size_type constexpr dim = target_functor::dim;
+
+    private:
+        typedef ublas::c_vector<value_type, dim> vector_type;
+
+        target_functor &target_;
+        vector_type p_, gradient_;
+
+    public:
+        LogTransform(target_functor &target) : target_(target){};
+        ~LogTransform(){};
+
+    public:
+        template <typename vect>
+        value_type operator()(vect const &z)
+        {
+            return target_(exponential(z));
+        }
+
+        template <typename vect, typename T = target_functor>
+        typename std::enable_if<has_bounded_evaluation<T, vector_type>::value, bool>::type
+        bounded(vect const &z, const value_type bound, value_type &value)
+        {
+            return target_.bounded(exponential(z), bound, value);
+        }
+
+        // chain rule, d target / d z_i = d target / d p_i * p_i
+        template <typename v1, typename v2>
+        void gradient(v1 const &z, const value_type target_value, v2 &grad)
+        {
+            assert(grad.size() == dim);
+            exponential(z);
+            target_.gradient(p_, target_value, gradient_);
+            for (size_type i = 0; i < dim; i++)
+                grad[i] = gradient_[i] * p_[i];
+        }
+
+    private:
+        template <typename vect>
+        const vector_type &exponential(vect const &z)
+        {
+            assert(z.size() == dim);
+            for (size_type i = 0; i < dim; i++)
+                p_[i] = std::exp(z[i]);
+            return p_;
+        }
+    };
+} // namespace optimization
+#endif
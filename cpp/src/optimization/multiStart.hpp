@@ -0,0 +1,122 @@
+#ifndef MULTISTART_HPP
+#define MULTISTART_HPP
+/*
+    Multi-start optimization - independent local searches from space filling starting points,
+    run in parallel, best optimum and spread of all optima are reported.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "../parallel/threadPool.hpp"
+
+namespace optimization
+{
+    // columns of points receive a Latin hypercube design in box [lower, upper],
+    // every variable has exactly one point in each of points.size2() equally wide strata
+    template <typename vector_type, typename matrix_type, typename rng_type>
+    void latin_hypercube(const vector_type &lower, const vector_type &upper, matrix_type &points, rng_type &rng)
+    {
+        typedef typename matrix_type::value_type value_type;
+        typedef typename matrix_type::size_type size_type;
+        assert(lower.size() == upper.size());
+        assert(points.size1() == lower.size());
+
+        const size_type no_points = points.size2();
+        std::uniform_real_distribution<value_type> uniform(0.0, 1.0);
+        std::vector<size_type> strata(no_points);
+        for (size_type i = 0; i < points.size1(); i++)
+        {
+            for (size_type j = 0; j < no_points; j++)
+                strata[j] = j;
+            std::shuffle(strata.begin(), strata.end(), rng);
+            for (size_type j = 0; j < no_points; j++)
+            {
+                const value_type u = (strata[j] + uniform(rng)) / no_points;
+                points(i, j) = lower[i] + u * (upper[i] - lower[i]);
+            }
+        }
+    }
+
+    template <typename Type>
+    struct MultiStartResult
+    {
+        typedef Type value_type;
+        typedef typename ublas::vector<value_type>::size_type size_type;
+
+        ublas::matrix<value_type, ublas::column_major> starts, optima; // one column per start
+        ublas::vector<value_type> targets;                            // target value at each optimum
+        size_type best;                                               // column of the lowest target
+        ublas::vector<value_type> mean, stddev, min, max;             // spread of optima per variable
+
+        MultiStartResult(const size_type dim, const size_type no_starts)
+            : starts(dim, no_starts), optima(dim, no_starts), targets(no_starts), best(0),
+              mean(dim), stddev(dim), min(dim), max(dim){};
+
+        // number of optima with target within relative tolerance of the best one
+        size_type no_near_best(const value_type rel_tol) const
+        {
+            return std::count_if(targets.begin(), targets.end(), [this, rel_tol](const value_type t) {
+                return t <= targets[best] * (1.0 + rel_tol);
+            });
+        }
+    };
+
+    /*
+////Uses concepts:
+optimize_functor
+    member functions:
+        value_type operator()(const vector_type &start, vector_type &optimum, size_type worker_index)
+            runs a local search from start, returns target value at optimum,
+            calls with distinct worker_index may run concurrently
+    */
+    // runs optimize from every column of result.starts on pool, then fills best and spread of result
+    template <typename value_type, typename optimize_functor>
+    void multi_start(parallel::ThreadPool &pool, MultiStartResult<value_type> &result, optimize_functor &optimize)
+    {
+        typedef typename MultiStartResult<value_type>::size_type size_type;
+        const size_type dim = result.starts.size1();
+        const size_type no_starts = result.starts.size2();
+        assert(no_starts > 0);
+
+        auto task = [&result, &optimize, dim](const size_type start, const size_type worker) {
+            ublas::vector<value_type> start_point(ublas::column(result.starts, start)), optimum(dim);
+            result.targets[start] = optimize(start_point, optimum, worker);
+            ublas::column(result.optima, start).assign(optimum);
+        };
+        pool.run(no_starts, task);
+
+        // nan targets (blown up solutions) never win
+        result.best = 0;
+        for (size_type j = 1; j < no_starts; j++)
+        {
+            if (result.targets[j] < result.targets[result.best] || std::isnan(result.targets[result.best]))
+                result.best = j;
+        }
+
+        for (size_type i = 0; i < dim; i++)
+        {
+            value_type sum = 0.0, sum_squares = 0.0;
+            result.min[i] = result.max[i] = result.optima(i, 0);
+            for (size_type j = 0; j < no_starts; j++)
+            {
+                const value_type x = result.optima(i, j);
+                sum += x;
+                sum_squares += x * x;
+                result.min[i] = std::min(result.min[i], x);
+                result.max[i] = std::max(result.max[i], x);
+            }
+            result.mean[i] = sum / no_starts;
+            result.stddev[i] = std::sqrt(std::max(sum_squares / no_starts - result.mean[i] * result.mean[i], (value_type)0.0));
+        }
+    }
+} // namespace optimization
+#endif
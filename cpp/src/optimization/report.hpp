@@ -0,0 +1,18 @@
+#ifndef OPTIMIZATION_REPORT_HPP
+#define OPTIMIZATION_REPORT_HPP
+/*
+    Outcome of an optimization run, optionally filled in by optimizers.
+*/
+
+#include <cstddef>
+
+namespace optimization
+{
+    struct Report
+    {
+        std::size_t iterations = 0;
+        bool converged = false;
+        bool line_search_failed = false; // stopped because no step decreased the target
+    };
+} // namespace optimization
+#endif
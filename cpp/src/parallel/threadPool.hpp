@@ -0,0 +1,115 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+/*
+    Fixed size pool of worker threads running batches of indexed tasks.
+*/
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel
+{
+    /*
+////Satisfies concepts:
+ThreadPool
+    constructor:
+        ThreadPool(const size_type no_threads)
+    member functions:
+        void run(size_type no_tasks, task_type &task)
+        size_type size() const
+
+////Uses concepts:
+task_type
+    member functions:
+        void operator()(size_type task_index, size_type worker_index)
+    */
+    class ThreadPool
+    {
+    public:
+        typedef std::size_t size_type;
+
+    private:
+        std::vector<std::thread> workers_;
+        std::function<void(size_type, size_type)> task_;
+        size_type no_tasks_, next_task_, finished_, generation_;
+        bool stop_;
+        std::mutex mutex_;
+        std::condition_variable wake_, done_;
+
+    public:
+        ThreadPool(const size_type no_threads)
+            : no_tasks_(0), next_task_(0), finished_(0), generation_(0), stop_(false)
+        {
+            assert(no_threads > 0);
+            workers_.reserve(no_threads);
+            for (size_type i = 0; i < no_threads; i++)
+            {
+                workers_.emplace_back([this, i]() { worker_loop(i); });
+            }
+        };
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto &worker : workers_)
+            {
+                worker.join();
+            }
+        };
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+    public:
+        size_type size() const { return workers_.size(); }
+
+        // runs task(i, worker) for i in 0..no_tasks-1, returns once all of them finished
+        template <typename task_type>
+        void run(const size_type no_tasks, task_type &task)
+        {
+            if (no_tasks == 0)
+                return;
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_ = std::ref(task);
+            no_tasks_ = no_tasks;
+            next_task_ = finished_ = 0;
+            generation_++;
+            wake_.notify_all();
+            done_.wait(lock, [this]() { return finished_ == no_tasks_; });
+            task_ = nullptr;
+        }
+
+    private:
+        void worker_loop(const size_type worker)
+        {
+            size_type generation = 0;
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true)
+            {
+                wake_.wait(lock, [this, &generation]() { return stop_ || generation_ != generation; });
+                if (stop_)
+                    return;
+                generation = generation_;
+                while (next_task_ < no_tasks_)
+                {
+                    const size_type task = next_task_++;
+                    lock.unlock();
+                    task_(task, worker);
+                    lock.lock();
+                    if (++finished_ == no_tasks_)
+                        done_.notify_one();
+                }
+            }
+        }
+    };
+} // namespace parallel
+
+#endif
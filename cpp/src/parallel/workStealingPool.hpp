@@ -0,0 +1,171 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+/*
+    Fixed size pool of worker threads running batches of indexed tasks with work stealing.
+    Every worker owns a queue of tasks, takes them from its front and, once empty, steals from the back
+    of other queues, so long running tasks do not leave the other workers idle.
+*/
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel
+{
+    /*
+////Satisfies concepts:
+ThreadPool
+    constructor:
+        WorkStealingPool(const size_type no_threads)
+    member functions:
+        void run(size_type no_tasks, task_type &task)
+        size_type size() const
+
+////Uses concepts:
+task_type
+    member functions:
+        void operator()(size_type task_index, size_type worker_index)
+    */
+    class WorkStealingPool
+    {
+    public:
+        typedef std::size_t size_type;
+
+    private:
+        struct task_queue
+        {
+            std::mutex mutex_;
+            std::deque<size_type> tasks_;
+        };
+
+    private:
+        std::vector<std::thread> workers_;
+        std::vector<std::unique_ptr<task_queue>> queues_;
+        std::function<void(size_type, size_type)> task_;
+        size_type no_tasks_, finished_, generation_;
+        bool stop_;
+        std::mutex mutex_;
+        std::condition_variable wake_, done_;
+
+    public:
+        WorkStealingPool(const size_type no_threads)
+            : no_tasks_(0), finished_(0), generation_(0), stop_(false)
+        {
+            assert(no_threads > 0);
+            for (size_type i = 0; i < no_threads; i++)
+            {
+                queues_.push_back(std::make_unique<task_queue>());
+            }
+            workers_.reserve(no_threads);
+            for (size_type i = 0; i < no_threads; i++)
+            {
+                workers_.emplace_back([this, i]() { worker_loop(i); });
+            }
+        };
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto &worker : workers_)
+            {
+                worker.join();
+            }
+        };
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    public:
+        size_type size() const { return workers_.size(); }
+
+        // runs task(i, worker) for i in 0..no_tasks-1, returns once all of them finished
+        // tasks are dealt to workers in contiguous blocks, so neighbouring tasks start on the same worker
+        template <typename task_type>
+        void run(const size_type no_tasks, task_type &task)
+        {
+            if (no_tasks == 0)
+                return;
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_ = std::ref(task);
+            no_tasks_ = no_tasks;
+            finished_ = 0;
+            const size_type no_queues = queues_.size();
+            for (size_type q = 0; q < no_queues; q++)
+            {
+                std::lock_guard<std::mutex> queue_lock(queues_[q]->mutex_);
+                for (size_type i = q * no_tasks / no_queues; i < (q + 1) * no_tasks / no_queues; i++)
+                {
+                    queues_[q]->tasks_.push_back(i);
+                }
+            }
+            generation_++;
+            wake_.notify_all();
+            done_.wait(lock, [this]() { return finished_ == no_tasks_; });
+            task_ = nullptr;
+        }
+
+    private:
+        // next task of worker, own queue first, then the back of the others, false when all are empty
+        bool next_task(const size_type worker, size_type &task)
+        {
+            const size_type no_queues = queues_.size();
+            {
+                task_queue &own = *queues_[worker];
+                std::lock_guard<std::mutex> lock(own.mutex_);
+                if (!own.tasks_.empty())
+                {
+                    task = own.tasks_.front();
+                    own.tasks_.pop_front();
+                    return true;
+                }
+            }
+            for (size_type i = 1; i < no_queues; i++)
+            {
+                task_queue &victim = *queues_[(worker + i) % no_queues];
+                std::lock_guard<std::mutex> lock(victim.mutex_);
+                if (!victim.tasks_.empty())
+                {
+                    task = victim.tasks_.back();
+                    victim.tasks_.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void worker_loop(const size_type worker)
+        {
+            size_type generation = 0;
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true)
+            {
+                wake_.wait(lock, [this, &generation]() { return stop_ || generation_ != generation; });
+                if (stop_)
+                    return;
+                generation = generation_;
+                lock.unlock();
+                // tasks are only added by run, empty queues mean nothing is left to start in this batch
+                size_type task;
+                while (next_task(worker, task))
+                {
+                    task_(task, worker);
+                    std::lock_guard<std::mutex> finished_lock(mutex_);
+                    if (++finished_ == no_tasks_)
+                        done_.notify_one();
+                }
+                lock.lock();
+            }
+        }
+    };
+} // namespace parallel
+
+#endif
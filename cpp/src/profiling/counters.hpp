@@ -0,0 +1,229 @@
+#ifndef COUNTERS_HPP
+#define COUNTERS_HPP
+/*
+    Always compiled event counters and phase timers of hot paths (right hand side and jacobian evaluations,
+    Newton iterations, line search backtracks, LSE evaluations and gradients).
+    Every thread increments its own counters without synchronization, totals are summed over all threads
+    on request, so a Profile taken around an optimizer run reports where its evaluations went.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace profiling
+{
+    enum class Event : unsigned
+    {
+        rhs,                   // right hand side of an ODE system
+        jacobian,              // jacobian of an ODE system
+        time_step,             // step of OdeSolver
+        adaptive_step,         // accepted internal step of an adaptive scheme
+        rejected_step,         // internal step of an adaptive scheme rejected by error control
+        newton_iteration,      // correction of newton solver of implicit schemes
+        factorization,         // LU factorization of iteration matrix (newton or rosenbrock)
+        krylov_iteration,      // product with newton iteration matrix in GMRES (matrix free)
+        line_search,           // call of LineSearch
+        line_search_backtrack, // step size halving in LineSearch
+        lse_evaluation,        // LSE value requested by optimizer (operator() and bounded)
+        lse_bound_exceeded,    // bounded evaluation stopped early
+        lse_solve,             // forward solve for LSE value, including finite difference gradients
+        lse_gradient,          // gradient requested by optimizer
+        count
+    };
+
+    static const char *const event_names[] = {"rhs", "jacobian", "time_step", "adaptive_step", "rejected_step",
+                                              "newton_iteration", "factorization", "krylov_iteration",
+                                              "line_search", "line_search_backtrack",
+                                              "lse_evaluation", "lse_bound_exceeded", "lse_solve", "lse_gradient"};
+    static_assert(sizeof(event_names) / sizeof(event_names[0]) == (unsigned)Event::count, "every event needs a name");
+
+    enum class Phase : unsigned
+    {
+        lse_evaluation,
+        lse_gradient,
+        count
+    };
+
+    static const char *const phase_names[] = {"lse_evaluation", "lse_gradient"};
+    static_assert(sizeof(phase_names) / sizeof(phase_names[0]) == (unsigned)Phase::count, "every phase needs a name");
+
+    struct Totals
+    {
+        std::uint64_t events[(unsigned)Event::count] = {};
+        std::uint64_t nanoseconds[(unsigned)Phase::count] = {};
+
+        std::uint64_t operator[](const Event e) const { return events[(unsigned)e]; }
+        double seconds(const Phase p) const { return nanoseconds[(unsigned)p] * 1e-9; }
+
+        Totals operator-(const Totals &other) const
+        {
+            Totals ret;
+            for (unsigned i = 0; i < (unsigned)Event::count; i++)
+                ret.events[i] = events[i] - other.events[i];
+            for (unsigned i = 0; i < (unsigned)Phase::count; i++)
+                ret.nanoseconds[i] = nanoseconds[i] - other.nanoseconds[i];
+            return ret;
+        }
+    };
+
+    namespace detail
+    {
+        // only the owning thread writes, relaxed load and store compile to a plain increment
+        typedef std::atomic<std::uint64_t> counter_type;
+        inline void add(counter_type &counter, const std::uint64_t n)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        struct ThreadCounters;
+
+        // counters of running threads and sums of finished ones
+        // running threads are linked through their counters, so the first count on a thread does not allocate
+        struct Registry
+        {
+            std::mutex mutex_;
+            ThreadCounters *threads_ = nullptr;
+            Totals finished_;
+        };
+
+        inline Registry &registry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        struct ThreadCounters
+        {
+            counter_type events_[(unsigned)Event::count];
+            counter_type nanoseconds_[(unsigned)Phase::count];
+            ThreadCounters *prev_, *next_;
+
+            ThreadCounters() : prev_(nullptr)
+            {
+                for (auto &c : events_)
+                    c.store(0, std::memory_order_relaxed);
+                for (auto &c : nanoseconds_)
+                    c.store(0, std::memory_order_relaxed);
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex_);
+                next_ = r.threads_;
+                if (next_)
+                    next_->prev_ = this;
+                r.threads_ = this;
+            }
+            ~ThreadCounters()
+            {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex_);
+                add_to(r.finished_);
+                if (prev_)
+                    prev_->next_ = next_;
+                else
+                    r.threads_ = next_;
+                if (next_)
+                    next_->prev_ = prev_;
+            }
+
+            void add_to(Totals &totals) const
+            {
+                for (unsigned i = 0; i < (unsigned)Event::count; i++)
+                    totals.events[i] += events_[i].load(std::memory_order_relaxed);
+                for (unsigned i = 0; i < (unsigned)Phase::count; i++)
+                    totals.nanoseconds[i] += nanoseconds_[i].load(std::memory_order_relaxed);
+            }
+        };
+
+        inline ThreadCounters &local()
+        {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+    } // namespace detail
+
+    inline void count(const Event e, const std::uint64_t n = 1)
+    {
+        detail::add(detail::local().events_[(unsigned)e], n);
+    }
+
+    // sums over all threads, running and finished
+    inline Totals totals()
+    {
+        detail::local(); // registry outlives counters of the calling thread
+        detail::Registry &r = detail::registry();
+        std::lock_guard<std::mutex> lock(r.mutex_);
+        Totals ret = r.finished_;
+        for (const detail::ThreadCounters *t = r.threads_; t; t = t->next_)
+            t->add_to(ret);
+        return ret;
+    }
+
+    // adds time from construction to destruction to phase of the calling thread
+    class PhaseTimer
+    {
+    private:
+        typedef std::chrono::steady_clock clock;
+        const Phase phase_;
+        const clock::time_point start_;
+
+    public:
+        PhaseTimer(const Phase phase) : phase_(phase), start_(clock::now()){};
+        ~PhaseTimer()
+        {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count();
+            detail::add(detail::local().nanoseconds_[(unsigned)phase_], elapsed);
+        }
+
+        PhaseTimer(const PhaseTimer &) = delete;
+        PhaseTimer &operator=(const PhaseTimer &) = delete;
+    };
+
+    // counters and wall time since construction, meant around one optimizer run
+    class Profile
+    {
+    private:
+        typedef std::chrono::steady_clock clock;
+        const Totals start_;
+        const clock::time_point start_time_;
+
+    public:
+        Profile() : start_(totals()), start_time_(clock::now()){};
+
+    public:
+        Totals counters() const { return totals() - start_; }
+        double seconds() const { return std::chrono::duration<double>(clock::now() - start_time_).count(); }
+
+        // nonzero counters, their number per iteration and share of wall time spent in phases
+        void print(std::ostream &out, const std::string &title, const std::size_t iterations) const
+        {
+            const Totals c = counters();
+            const double wall = seconds();
+            out << title << " profile: " << iterations << " iterations, " << wall << " s" << std::endl;
+            for (unsigned i = 0; i < (unsigned)Event::count; i++)
+            {
+                if (c.events[i] == 0)
+                    continue;
+                out << "  " << std::left << std::setw(24) << event_names[i] << std::right << std::setw(12) << c.events[i];
+                if (iterations > 0)
+                    out << std::setw(14) << (double)c.events[i] / iterations << " per iteration";
+                out << std::endl;
+            }
+            double phases = 0.0;
+            for (unsigned i = 0; i < (unsigned)Phase::count; i++)
+            {
+                const double time = c.seconds((Phase)i);
+                phases += time;
+                out << "  " << std::left << std::setw(24) << phase_names[i] << std::right << std::setw(12) << time
+                    << " s" << std::setw(12) << 100.0 * time / wall << " %" << std::endl;
+            }
+            out << "  " << std::left << std::setw(24) << "other" << std::right << std::setw(12) << wall - phases
+                << " s" << std::setw(12) << 100.0 * (wall - phases) / wall << " %" << std::endl;
+        }
+    };
+} // namespace profiling
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef ASYNCWRITER_HPP
+#define ASYNCWRITER_HPP
+/*
+    Background writer thread with a fixed pool of result buffers.
+    The solver takes a free buffer, fills it and hands it over together with a write job, then continues
+    with the next solve while the writer thread saves the buffer and returns it to the pool.
+    Memory stays fixed - once all buffers are queued for writing, acquire waits for the writer.
+    Jobs report to a stream of their own, its text is printed to std::cout by the solver thread
+    (in acquire, wait and destructor), so it does not interleave with what the solver thread prints.
+*/
+
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace saving
+{
+    /*
+////Uses concepts:
+write_job
+    member functions:
+        void operator()(const buffer_type &buffer, std::ostream &log)
+    */
+    template <typename buffer_type>
+    class AsyncWriter
+    {
+    public:
+        typedef std::size_t size_type;
+        typedef std::function<void(const buffer_type &, std::ostream &)> job_type;
+
+    private:
+        std::vector<std::unique_ptr<buffer_type>> buffers_;
+        std::vector<buffer_type *> free_;
+        std::deque<std::pair<buffer_type *, job_type>> queue_;
+        std::string log_; // reports of finished jobs not printed yet
+        bool stop_;
+        std::mutex mutex_;
+        std::condition_variable queued_, released_;
+        std::thread writer_;
+
+    public:
+        // no_buffers buffers constructed from args, 2 give double buffering
+        template <typename... Args>
+        AsyncWriter(const size_type no_buffers, const Args... args) : stop_(false)
+        {
+            assert(no_buffers > 0);
+            for (size_type i = 0; i < no_buffers; i++)
+            {
+                buffers_.push_back(std::make_unique<buffer_type>(args...));
+                free_.push_back(buffers_.back().get());
+            }
+            writer_ = std::thread([this]() { writer_loop(); });
+        };
+        // remaining queued jobs are written before the thread finishes
+        ~AsyncWriter()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            queued_.notify_one();
+            writer_.join();
+            std::cout << log_ << std::flush;
+        };
+
+        AsyncWriter(const AsyncWriter &) = delete;
+        AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+    public:
+        // free buffer, waits until the writer releases one if all are in use
+        buffer_type &acquire()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            released_.wait(lock, [this]() { return !free_.empty(); });
+            buffer_type *buffer = free_.back();
+            free_.pop_back();
+            print_log();
+            return *buffer;
+        }
+
+        // buffer obtained from acquire is written by job on the writer thread, then returned to the pool
+        template <typename job_functor>
+        void submit(buffer_type &buffer, job_functor job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.emplace_back(&buffer, job_type(std::move(job)));
+            }
+            queued_.notify_one();
+        }
+
+        // waits until all submitted jobs are written
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            released_.wait(lock, [this]() { return free_.size() == buffers_.size(); });
+            print_log();
+        }
+
+    private:
+        // called with mutex_ locked on the solver thread
+        void print_log()
+        {
+            std::cout << log_ << std::flush;
+            log_.clear();
+        }
+
+        void writer_loop()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true)
+            {
+                queued_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                if (queue_.empty())
+                    return;
+                auto item = std::move(queue_.front());
+                queue_.pop_front();
+                lock.unlock();
+                std::ostringstream log;
+                item.second(*item.first, log);
+                lock.lock();
+                log_ += log.str();
+                free_.push_back(item.first);
+                released_.notify_all();
+            }
+        }
+    };
+} // namespace saving
+
+#endif
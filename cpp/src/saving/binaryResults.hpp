@@ -0,0 +1,224 @@
+#ifndef BINARYRESULTS_HPP
+#define BINARYRESULTS_HPP
+/*
+    Binary columnar trajectory files - header followed by one series per variable (row of the results matrix).
+    Series are stored raw, or quantized to multiples of quantum and delta encoded as zigzag varints,
+    which shrinks smooth trajectories several times at absolute error of quantum / 2 (plus rounding of the value type).
+
+    Header: magic "SIQRDTRJ", value size in bytes, encoding, no_steps + 1, decimation, dim, dT, quantum
+    Stored columns of the results matrix are the same as in text files: every decimation-th and the last one.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace saving
+{
+    enum class Encoding : std::uint32_t
+    {
+        raw = 0,
+        quantized_delta = 1
+    };
+
+    struct TrajectoryHeader
+    {
+        char magic[8];         // "SIQRDTRJ"
+        std::uint32_t dtype;   // sizeof of stored floating point type (raw encoding)
+        std::uint32_t encoding;
+        std::uint64_t no_columns, decimation, dim; // columns of the full results matrix
+        double dT, quantum;
+    };
+    static_assert(sizeof(TrajectoryHeader) == 56, "trajectory header has to be 56 bytes");
+
+    static const char constexpr trajectory_magic[8] = {'S', 'I', 'Q', 'R', 'D', 'T', 'R', 'J'};
+
+    inline std::uint64_t stored_columns(const std::uint64_t no_columns, const std::uint64_t decimation)
+    {
+        return no_columns == 0 ? 0 : (no_columns - 1) / decimation + 1 + ((no_columns - 1) % decimation != 0);
+    }
+
+    // column of the results matrix stored as k-th one
+    inline std::uint64_t stored_column(const std::uint64_t k, const std::uint64_t no_columns, const std::uint64_t decimation)
+    {
+        return std::min(k * decimation, no_columns - 1);
+    }
+
+    namespace detail
+    {
+        inline void put_varint(std::vector<unsigned char> &out, std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back((unsigned char)(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back((unsigned char)value);
+        }
+
+        // false if the varint is not complete before end or longer than 64 bits
+        inline bool get_varint(const unsigned char *&in, const unsigned char *end, std::uint64_t &value)
+        {
+            value = 0;
+            for (unsigned shift = 0; in != end && shift < 64; shift += 7)
+            {
+                const unsigned char byte = *in++;
+                value |= (std::uint64_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        inline std::uint64_t zigzag(const std::int64_t value) { return ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63); }
+        inline std::int64_t unzigzag(const std::uint64_t value) { return (std::int64_t)(value >> 1) ^ -(std::int64_t)(value & 1); }
+    } // namespace detail
+
+    // quantum 0 stores raw values, so do non-finite values or values too large for quantum; progress is reported to log
+    template <typename T, typename matrix_type, typename string>
+    void saveResultsBinary(const T dT, const matrix_type &variables_matrix, const string &file_name,
+                           const std::size_t decimation = 1, const double quantum = 0.0,
+                           [[maybe_unused]] std::ostream &log = std::cout)
+    {
+        typedef typename matrix_type::value_type value_type;
+        assert(decimation > 0 && quantum >= 0.0);
+#ifndef NINFO
+        log << "Writing results to " << file_name << "...       ";
+#endif
+        TrajectoryHeader header;
+        std::memcpy(header.magic, trajectory_magic, sizeof(header.magic));
+        header.dtype = sizeof(value_type);
+        header.no_columns = variables_matrix.size2();
+        header.decimation = decimation;
+        header.dim = variables_matrix.size1();
+        header.dT = dT;
+        header.quantum = quantum;
+        const std::uint64_t no_stored = stored_columns(header.no_columns, decimation);
+
+        std::vector<unsigned char> encoded;
+        bool quantize = quantum > 0.0;
+        const double limit = std::ldexp(quantum, 62);
+        for (std::uint64_t i = 0; i < header.dim && quantize; i++)
+        {
+            std::int64_t previous = 0;
+            for (std::uint64_t k = 0; k < no_stored; k++)
+            {
+                const double value = variables_matrix(i, stored_column(k, header.no_columns, decimation));
+                if (!(std::abs(value) < limit))
+                {
+                    quantize = false;
+                    break;
+                }
+                const std::int64_t current = std::llround(value / quantum);
+                detail::put_varint(encoded, detail::zigzag(current - previous));
+                previous = current;
+            }
+        }
+        header.encoding = (std::uint32_t)(quantize ? Encoding::quantized_delta : Encoding::raw);
+
+        std::ofstream file(file_name, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (quantize)
+        {
+            file.write(reinterpret_cast<const char *>(encoded.data()), encoded.size());
+        }
+        else
+        {
+            std::vector<value_type> series(no_stored);
+            for (std::uint64_t i = 0; i < header.dim; i++)
+            {
+                for (std::uint64_t k = 0; k < no_stored; k++)
+                    series[k] = variables_matrix(i, stored_column(k, header.no_columns, decimation));
+                file.write(reinterpret_cast<const char *>(series.data()), no_stored * sizeof(value_type));
+            }
+        }
+#ifndef NINFO
+        log << "done." << std::endl
+                  << std::endl;
+#endif
+    }
+
+    // reads a file written by saveResultsBinary, variables_matrix gets one column per stored time in times;
+    // exits with a message if the file is truncated or its header does not match its contents
+    template <typename matrix_type, typename vector_type>
+    void loadResultsBinary(const std::string &file_name, matrix_type &variables_matrix, vector_type &times)
+    {
+        typedef typename matrix_type::value_type value_type;
+        std::ifstream file(file_name, std::ios::binary);
+        TrajectoryHeader header;
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, trajectory_magic, sizeof(header.magic)) != 0)
+        {
+            std::cerr << "Cannot read trajectory file " << file_name << std::endl;
+            std::exit(1);
+        }
+        const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const bool quantized = header.encoding == (std::uint32_t)Encoding::quantized_delta;
+        if (header.decimation == 0 || header.dim == 0 || (!quantized && header.encoding != (std::uint32_t)Encoding::raw))
+        {
+            std::cerr << "Trajectory file " << file_name << " has invalid header" << std::endl;
+            std::exit(1);
+        }
+        const std::uint64_t no_stored = stored_columns(header.no_columns, header.decimation);
+        // every quantized value takes at least one byte, raw ones exactly value size (checked without overflow)
+        const std::uint64_t value_bytes = quantized ? 1 : sizeof(value_type), capacity = data.size() / value_bytes;
+        const bool fits = no_stored == 0 ? data.empty()
+                                         : header.dim <= capacity / no_stored &&
+                                               (quantized || header.dim * no_stored * value_bytes == data.size());
+        if ((!quantized && header.dtype != sizeof(value_type)) || !fits)
+        {
+            std::cerr << "Trajectory file " << file_name << " does not hold " << (quantized ? "quantized" : "raw")
+                      << " values of expected size" << std::endl;
+            std::exit(1);
+        }
+        variables_matrix.resize(header.dim, no_stored, false);
+        times.resize(no_stored);
+        for (std::uint64_t k = 0; k < no_stored; k++)
+            times[k] = stored_column(k, header.no_columns, header.decimation) * header.dT;
+
+        if (quantized)
+        {
+            const unsigned char *in = data.data(), *end = data.data() + data.size();
+            for (std::uint64_t i = 0; i < header.dim; i++)
+            {
+                std::int64_t current = 0;
+                for (std::uint64_t k = 0; k < no_stored; k++)
+                {
+                    std::uint64_t delta;
+                    if (!detail::get_varint(in, end, delta))
+                    {
+                        std::cerr << "Trajectory file " << file_name << " is truncated" << std::endl;
+                        std::exit(1);
+                    }
+                    current += detail::unzigzag(delta);
+                    variables_matrix(i, k) = current * header.quantum;
+                }
+            }
+            if (in != end)
+            {
+                std::cerr << "Trajectory file " << file_name << " holds more data than its header" << std::endl;
+                std::exit(1);
+            }
+            return;
+        }
+        for (std::uint64_t i = 0; i < header.dim; i++)
+        {
+            for (std::uint64_t k = 0; k < no_stored; k++)
+            {
+                value_type value;
+                std::memcpy(&value, &data[(i * no_stored + k) * sizeof(value_type)], sizeof(value));
+                variables_matrix(i, k) = value;
+            }
+        }
+    }
+} // namespace saving
+
+#endif
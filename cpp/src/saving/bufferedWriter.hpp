@@ -0,0 +1,79 @@
+#ifndef BUFFEREDWRITER_HPP
+#define BUFFEREDWRITER_HPP
+/*
+    Text output formatted by std::to_chars into a large buffer, written to file only when the buffer is full
+    and at the end. Numbers look like std::ostream with default settings (%g, precision 6).
+*/
+
+#include <cassert>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace saving
+{
+    class BufferedWriter
+    {
+    public:
+        typedef std::size_t size_type;
+
+    private:
+        std::ofstream file_;
+        std::vector<char> buffer_;
+        size_type used_;
+
+        static const size_type constexpr capacity = 1 << 20;
+        static const size_type constexpr max_number_length = 64; // longest formatted number, with margin
+        static const int constexpr precision = 6;                // default precision of std::ostream
+
+    public:
+        BufferedWriter(const std::string &file_name) : file_(file_name, std::ios::binary), buffer_(capacity), used_(0){};
+        ~BufferedWriter() { flush(); };
+
+        BufferedWriter(const BufferedWriter &) = delete;
+        BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    public:
+        template <typename T>
+        typename std::enable_if<std::is_floating_point<T>::value>::type write(const T value)
+        {
+            reserve(max_number_length);
+            const auto result = std::to_chars(&buffer_[used_], &buffer_[0] + capacity, value,
+                                              std::chars_format::general, precision);
+            assert(result.ec == std::errc());
+            used_ = result.ptr - &buffer_[0];
+        }
+
+        void write(const char *text)
+        {
+            const size_type length = std::strlen(text);
+            reserve(length);
+            if (length > capacity)
+            {
+                file_.write(text, length);
+                return;
+            }
+            std::memcpy(&buffer_[used_], text, length);
+            used_ += length;
+        }
+
+        void flush()
+        {
+            file_.write(buffer_.data(), used_);
+            file_.flush();
+            used_ = 0;
+        }
+
+    private:
+        void reserve(const size_type length)
+        {
+            if (capacity - used_ < length)
+                flush();
+        }
+    };
+} // namespace saving
+
+#endif
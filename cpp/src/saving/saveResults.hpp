@@ -4,33 +4,45 @@
     funciton to save a matrix to file with first column containing increments of dT
 */
 
-#include <fstream>
+#include <cassert>
+#include <iostream>
+
+#include "bufferedWriter.hpp"
+
 namespace saving
 {
+    // decimation k writes every k-th column and the last one, progress is reported to log
     template <typename T, typename matrix_type, typename string>
-    void saveResults(const T dT, const matrix_type &variables_matrix, const string &file_name)
+    void saveResults(const T dT, const matrix_type &variables_matrix, const string &file_name, const std::size_t decimation = 1,
+                     [[maybe_unused]] std::ostream &log = std::cout)
     {
-
+        assert(decimation > 0);
 #ifndef NINFO
-        std::cout << "Writing results to " << file_name << "...       ";
+        log << "Writing results to " << file_name << "...       ";
 #endif
         T time = 0.0;
-        std::ofstream outputFile(file_name);
+        BufferedWriter outputFile(file_name);
+        const auto last = variables_matrix.size2() - 1;
         for (decltype(variables_matrix.size2()) j = 0; j < variables_matrix.size2(); j++)
         {
-            outputFile << time << "  \t";
-            for (decltype(variables_matrix.size1()) i = 0; i < variables_matrix.size1(); i++)
+            if (j % decimation == 0 || j == last)
             {
-                outputFile << variables_matrix(i, j) << "  \t";
+                outputFile.write(time);
+                outputFile.write("  \t");
+                for (decltype(variables_matrix.size1()) i = 0; i < variables_matrix.size1(); i++)
+                {
+                    outputFile.write(variables_matrix(i, j));
+                    outputFile.write("  \t");
+                }
+                outputFile.write("\n");
             }
-            outputFile << std::endl;
             time += dT;
         }
 #ifndef NINFO
-        std::cout << "done." << std::endl
+        log << "done." << std::endl
                   << std::endl;
 #endif
     }
 } // namespace saving
 
-#endif
\ No newline at end of file
+#endif
@@ -3,7 +3,9 @@
     Purpose:  Simulates SIQRD equations with all methods. Variation of delta parameter and output file names are hardcoded.
     Author:   pavel.macak@fs.cvut.cz
     Compilation: Makefile is provided - make run1 to run after compilation, make simulation to only compile.
-    Command line arguments: (2) Number of time steps and final simulation time.
+    Command line arguments: (2-4) Number of time steps and final simulation time,
+                            optionally decimation (every k-th step is written, default 1) and quantum,
+                            which switches to binary '.bin' output quantized to multiples of quantum (0 - raw values).
     Input files: 'parameters.in'
     Output files: Yes
 */
@@ -29,6 +31,8 @@ namespace ublas = boost::numeric::ublas;
 #include "ode/heun.hpp"
 #include "ode/eulerBackward.hpp"
 #include "saving/saveResults.hpp"
+#include "saving/binaryResults.hpp"
+#include "saving/asyncWriter.hpp"
 
 int main(int argc, char const *argv[])
 {
@@ -37,7 +41,7 @@ int main(int argc, char const *argv[])
 #ifndef NINFO
     std::cout << "Program started." << std::endl;
 #endif
-    assert(argc == 3);
+    assert(argc >= 3 && argc <= 5);
 
 #ifdef DLVL0
     std::cout << "Command line arguments: " << std::endl;
@@ -49,35 +53,52 @@ int main(int argc, char const *argv[])
 #endif
     int N = atoi(argv[1]);
     working_precision T = atof(argv[2]);
+    const int decimation = argc > 3 ? atoi(argv[3]) : 1;
+    const bool binary = argc > 4;
+    const double quantum = binary ? atof(argv[4]) : 0.0;
 
     assert(N > 0);
     assert(T > 0);
+    assert(decimation > 0);
+    assert(quantum >= 0.0);
 
     siqrd::OdeSys_SIQRD<working_precision> eqns("inputs/parameters.in");
     typedef typename ode::EulerForward<decltype(eqns)> fwe;
     typedef typename ode::EulerBackward<decltype(eqns)> bwe;
     typedef typename ode::Heun<decltype(eqns)> heun;
 
-    ublas::matrix<working_precision, ublas::column_major> scratch_space(decltype(eqns)::dim, N + 1);
+    typedef ublas::matrix<working_precision, ublas::column_major> result_matrix;
     auto parameters = eqns.parameters();
 
     ode::OdeSolver<fwe> fwe_solver(N, T);
     ode::OdeSolver<bwe> bwe_solver(N, T);
     ode::OdeSolver<heun> heun_solver(N, T);
 
-    parameters[3] = 0.0;
-    eqns.set_parameters(parameters);
-    fwe_solver.solve(eqns, scratch_space);
+    // results are written on a background thread while the next scenario is solved, two buffers in flight
+    saving::AsyncWriter<result_matrix> writer(2, decltype(eqns)::dim, N + 1);
+    auto solve_and_save = [&](auto &solver, const std::string &name) {
+        result_matrix &scratch_space = writer.acquire();
+        solver.solve(eqns, scratch_space);
 #ifdef DLVL1
-    std::cout << "Last values: " << std::endl
-              << "Suspicable:  " << scratch_space(0, N) << std::endl
-              << "Infected:    " << scratch_space(1, N) << std::endl
-              << "Quarantined: " << scratch_space(2, N) << std::endl
-              << "Recovered:   " << scratch_space(3, N) << std::endl
-              << "Dead:        " << scratch_space(4, N) << std::endl
-              << std::endl;
+        std::cout << "Last values: " << std::endl
+                  << "Suspicable:  " << scratch_space(0, N) << std::endl
+                  << "Infected:    " << scratch_space(1, N) << std::endl
+                  << "Quarantined: " << scratch_space(2, N) << std::endl
+                  << "Recovered:   " << scratch_space(3, N) << std::endl
+                  << "Dead:        " << scratch_space(4, N) << std::endl
+                  << std::endl;
 #endif
-    saving::saveResults(T / N, scratch_space, "outputs/fwe_no_measures.out");
+        writer.submit(scratch_space, [=](const result_matrix &results, std::ostream &log) {
+            if (binary)
+                saving::saveResultsBinary(T / N, results, "outputs/" + name + ".bin", decimation, quantum, log);
+            else
+                saving::saveResults(T / N, results, "outputs/" + name + ".out", decimation, log);
+        });
+    };
+
+    parameters[3] = 0.0;
+    eqns.set_parameters(parameters);
+    solve_and_save(fwe_solver, "fwe_no_measures");
 
     parameters[3] = 0.2;
     eqns.set_parameters(parameters);
@@ -88,31 +109,12 @@ int main(int argc, char const *argv[])
     // parameters <<= 15000, 5, 0, 0, 0;
     // eqns.set_initial_condition(parameters);
 
-    bwe_solver.solve(eqns, scratch_space);
-#ifdef DLVL1
-    std::cout << "Last values: " << std::endl
-              << "Suspicable:  " << scratch_space(0, N) << std::endl
-              << "Infected:    " << scratch_space(1, N) << std::endl
-              << "Quarantined: " << scratch_space(2, N) << std::endl
-              << "Recovered:   " << scratch_space(3, N) << std::endl
-              << "Dead:        " << scratch_space(4, N) << std::endl
-              << std::endl;
-#endif
-    saving::saveResults(T / N, scratch_space, "outputs/bwe_quarantine.out");
+    solve_and_save(bwe_solver, "bwe_quarantine");
 
     parameters[3] = 0.9;
     eqns.set_parameters(parameters);
-    heun_solver.solve(eqns, scratch_space);
-#ifdef DLVL1
-    std::cout << "Last values: " << std::endl
-              << "Suspicable:  " << scratch_space(0, N) << std::endl
-              << "Infected:    " << scratch_space(1, N) << std::endl
-              << "Quarantined: " << scratch_space(2, N) << std::endl
-              << "Recovered:   " << scratch_space(3, N) << std::endl
-              << "Dead:        " << scratch_space(4, N) << std::endl
-              << std::endl;
-#endif
-    saving::saveResults(T / N, scratch_space, "outputs/heun_lockdown.out");
+    solve_and_save(heun_solver, "heun_lockdown");
+    writer.wait();
 
 #ifndef NINFO
     std::cout << "Program finished." << std::endl;
@@ -2,18 +2,62 @@
 #define LSE_SIQRD_HPP
 /*
     Least square error calculation of SIQRD equations. 
-    Also LSE gradient approximation using finite difference. 
+    Also LSE gradient approximation using finite difference, optionally with perturbed solves in parallel,
+    or exact gradient using forward sensitivity equations or discrete adjoint.
 */
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
 namespace ublas = boost::numeric::ublas;
 
 #include "odeSys_siqrd.hpp"
+#include "observations.hpp"
 #include "../ode/odeSolver.hpp"
+#include "../ode/odeSys_sensitivity.hpp"
+#include "../ode/adjointSolver.hpp"
+#include "../parallel/threadPool.hpp"
+#include "../profiling/counters.hpp"
 
 namespace siqrd
 {
+    // method used by LSE_siqrd::gradient
+    enum class GradientMethod
+    {
+        forward_difference,
+        central_difference,
+        sensitivity, // exact gradient of the discrete solution from forward sensitivity equations
+        adjoint      // exact gradient of the discrete solution from a backward adjoint sweep
+    };
+
+    // time steps of a scheme between two observation days, schemes declaring order of at least 3 (RK4, Bogacki-Shampine,
+    // Dormand-Prince, Rodas3) reach accuracy of 8 Heun steps with fewer, specialize for other schemes
+    template <typename SchemeType, typename = void>
+    struct substeps_per_day
+    {
+        static const std::size_t constexpr value = 8;
+    };
+
+    template <typename SchemeType>
+    struct substeps_per_day<SchemeType, std::enable_if_t<(SchemeType::order >= 3)>>
+    {
+        static const std::size_t constexpr value = SchemeType::order >= 4 ? 2 : 4;
+    };
+
+    // adaptive schemes (AdaptiveRK) choose their own steps, one time_step reaches the next day by dense output
+    template <typename SchemeType>
+    struct substeps_per_day<SchemeType, std::enable_if_t<SchemeType::adaptive>>
+    {
+        static const std::size_t constexpr value = 1;
+    };
 
     /*
     pases SchemeType concept to OdeSolver template
@@ -25,6 +69,17 @@ target_functor
     member functions:
         value_type target_fun(const& variables_vector)
         void gradient(const& variables_vector, const& value_type, & gradient_vect_out)
+        bool bounded(const& variables_vector, value_type bound, & value_type value_out)
+    static variables:
+        size_type dim
+
+residual_functor
+    member types:
+        size_type, value_type
+    member functions:
+        size_type no_residuals()
+        void residuals(const& variables_vector, & residual_vect_out)
+        void residual_jacobian(const& variables_vector, & residual_vect_out, & jacobian_matrix_out)
     static variables:
         size_type dim
     */
@@ -38,19 +93,43 @@ target_functor
                                         typename SchemeType::size_type>::type size_type;
         typedef SchemeType method;
 
+    private:
+        // everything a single solve writes to, one per worker thread
+        struct workspace
+        {
+            OdeSys_SIQRD<value_type, size_type> eqns_;
+            ode::OdeSolver<SchemeType> solver_;
+            ublas::vector<value_type> params_temp_;
+        };
+
     private:
         size_type no_days_;
-        ublas::matrix<value_type, ublas::column_major> prediction_;
-        ublas::matrix<value_type, ublas::column_major> scratch_space_;
-        ublas::vector<value_type> params_temp_, init_cond_;
+        size_type no_steps_;
+        Observations<value_type> observations_;
+        // view of observations_ data, no copy
+        ublas::matrix<value_type, ublas::column_major, ublas::array_adaptor<value_type>> prediction_;
+        ublas::vector<value_type> params_temp_, init_cond_, perturbed_lse_;
         value_type pop_size_squared_;
 
-        static const size_type constexpr RATIO = 8;
+        static const size_type constexpr RATIO = substeps_per_day<SchemeType>::value; // time steps per day
         static const value_type constexpr EPS = 1e-5; // step value for finite difference
 
         OdeSys_SIQRD<value_type, size_type> eqns_;
         ode::OdeSolver<SchemeType> solver_;
 
+        GradientMethod gradient_method_;
+        std::unique_ptr<parallel::ThreadPool> pool_;
+        std::vector<workspace> workspaces_;
+
+        // state augmented with its sensitivities, integrated by the same method
+        typedef ode::OdeSys_sensitivity<OdeSys_SIQRD<value_type, size_type>> sens_eqns_type;
+        sens_eqns_type sens_eqns_;
+        ode::OdeSolver<typename ode::rebind_scheme<SchemeType, sens_eqns_type>::type> sens_solver_;
+
+        // forward and backward sweep with checkpoints, cost of the adjoint sweep does not grow with dim
+        ode::AdjointSolver<SchemeType> adjoint_solver_;
+        size_type checkpoint_interval_;
+
     private:
         const static size_type constexpr eqns_dim = OdeSys_SIQRD<>::dim;
 
@@ -58,29 +137,31 @@ target_functor
         const static size_type constexpr dim = OdeSys_SIQRD<>::no_params;
 
     public:
-        LSE_siqrd(const std::string &observation_file, const std::string &parameter_file) : params_temp_(dim)
+        LSE_siqrd(const std::string &observation_file, const std::string &parameter_file)
+            : observations_(observation_file), params_temp_(dim), perturbed_lse_(2 * dim),
+              gradient_method_(GradientMethod::forward_difference), checkpoint_interval_(0)
         {
-            std::ifstream file(observation_file);
-            size_type file_dim;
-            file >> no_days_ >> file_dim;
-            assert(file_dim == eqns_dim);
-            prediction_ = ublas::matrix<value_type, ublas::column_major>(eqns_dim, no_days_);
-            scratch_space_ = ublas::matrix<value_type, ublas::column_major>(eqns_dim, (no_days_ - 1) * RATIO + 1);
-
+            // unreadable observations leave object empty, callers check good()
+            no_days_ = no_steps_ = 0;
+            pop_size_squared_ = 0;
             eqns_ = decltype(eqns_)(parameter_file, false);
-            solver_ = decltype(solver_)(scratch_space_.size2() - 1, (value_type)(no_days_ - 1));
-
-            value_type unused;
-            for (size_type i = 0; i < no_days_; i++)
+            if (!observations_.good())
+                return;
+            if (observations_.dim() != eqns_dim)
             {
-                file >> unused;
-                for (size_type j = 0; j < eqns_dim; j++)
-                {
-                    file >> prediction_(j, i);
-                }
+                std::cerr << "Observation file " << observation_file << " has " << observations_.dim()
+                          << " compartments instead of " << eqns_dim << std::endl;
+                return;
             }
+            no_days_ = observations_.no_days();
+            prediction_.resize(eqns_dim, no_days_, false);
+            prediction_.data().resize(eqns_dim * no_days_, observations_.data());
+            no_steps_ = (no_days_ - 1) * RATIO;
+
+            solver_ = decltype(solver_)(no_steps_, (value_type)(no_days_ - 1));
+            sens_solver_ = decltype(sens_solver_)(no_steps_, (value_type)(no_days_ - 1));
+
             // std::cout << prediction_ << std::endl;
-            file.close();
             init_cond_ = ublas::column(prediction_, 0);
             eqns_.set_initial_condition(init_cond_);
             pop_size_squared_ = std::accumulate(init_cond_.begin(), init_cond_.end(), 0.0);
@@ -89,39 +170,183 @@ target_functor
         ~LSE_siqrd(){};
 
     public:
+        // sensitivity equations (sensitivity gradient, residual_jacobian of Levenberg-Marquardt) give derivatives
+        // of the discrete solution only with schemes of exact_sensitivity, message is printed otherwise
+        static bool sensitivity_available()
+        {
+            if constexpr (!ode::exact_sensitivity<SchemeType>::value)
+            {
+                std::cerr << "Sensitivities of " << SchemeType::method_name << " are not derivatives of its solution, "
+                          << "use finite difference gradient and an optimizer other than LM." << std::endl;
+            }
+            return ode::exact_sensitivity<SchemeType>::value;
+        }
+
+        // adjoint gradient needs a scheme with discrete adjoint, message is printed otherwise
+        static bool adjoint_available()
+        {
+            if constexpr (!ode::has_adjoint<SchemeType>::value)
+            {
+                std::cerr << "Adjoint gradient is not available with " << SchemeType::method_name << ", use "
+                          << (ode::exact_sensitivity<SchemeType>::value ? "sensitivity or " : "") << "finite difference gradient."
+                          << std::endl;
+            }
+            return ode::has_adjoint<SchemeType>::value;
+        }
+
+        // no_threads > 1 runs the perturbed solves of finite differences on a thread pool,
+        // exact gradient (sensitivity, adjoint) is a single sequential solve and does not use it;
+        // returns false and keeps the previous method if the scheme does not support the exact one
+        bool set_gradient(const GradientMethod method, const size_type no_threads = 1)
+        {
+            assert(no_threads > 0);
+            if ((method == GradientMethod::sensitivity && !sensitivity_available()) ||
+                (method == GradientMethod::adjoint && !adjoint_available()))
+                return false;
+#ifndef NINFO
+            if (no_threads > 1 && (method == GradientMethod::sensitivity || method == GradientMethod::adjoint))
+                std::cout << "Exact gradient is a single solve, " << no_threads << " threads are not used." << std::endl;
+#endif
+            gradient_method_ = method;
+            pool_.reset();
+            workspaces_.clear();
+            if (method == GradientMethod::sensitivity)
+            {
+                sens_solver_ = decltype(sens_solver_)(no_steps_, (value_type)(no_days_ - 1));
+            }
+            else if (method == GradientMethod::adjoint)
+            {
+                adjoint_solver_ = decltype(adjoint_solver_)(no_steps_, (value_type)(no_days_ - 1), checkpoint_interval_);
+            }
+            else if (no_threads > 1)
+            {
+                pool_ = std::make_unique<parallel::ThreadPool>(no_threads);
+                workspaces_.resize(no_threads, workspace{eqns_, solver_, params_temp_});
+            }
+            return true;
+        }
+
+        // number of steps between stored states of the adjoint method, 0 picks sqrt of number of steps
+        void set_checkpoint_interval(const size_type interval)
+        {
+            checkpoint_interval_ = interval;
+            if (gradient_method_ == GradientMethod::adjoint)
+                set_gradient(gradient_method_);
+        }
+
+    public:
+        // observations and parameters were read, message is printed otherwise
+        bool good() const
+        {
+            const ublas::vector<value_type> p = eqns_.parameters();
+            return no_days_ > 0 && std::all_of(p.begin(), p.end(), [](const value_type v) { return std::isfinite(v); });
+        }
+
         auto get_eqns() { return eqns_; }
         auto get_N() { return no_days_ * RATIO; }
         auto get_T() { return no_days_; }
+        size_type no_days() const { return no_days_; }
+
+        // observations compared with solution, eqns dim x no_days
+        const auto &observations() const { return prediction_; }
+
+        // replaces observations in place (same number of days, no allocation), initial condition is taken from day 0,
+        // used by bootstrap replicates to refit with resampled data
+        template <typename matrix_type>
+        void set_observations(const matrix_type &obs)
+        {
+            assert(obs.size1() == eqns_dim && obs.size2() == no_days_);
+            prediction_.assign(obs);
+            init_cond_ = ublas::column(prediction_, 0);
+            eqns_.set_initial_condition(init_cond_);
+            pop_size_squared_ = std::accumulate(init_cond_.begin(), init_cond_.end(), 0.0);
+            pop_size_squared_ *= pop_size_squared_;
+        }
+
+        // solution at whole days (eqns dim x no_days), discretized the same way as in LSE
+        template <typename vect, typename matrix_type>
+        void states_at_days(vect const &p, matrix_type &states)
+        {
+            assert(p.size() == dim);
+            assert(states.size1() == eqns_dim && states.size2() == no_days_);
+            eqns_.set_initial_condition(init_cond_);
+            eqns_.set_parameters(p);
+            auto store = [&states](const size_type step, const auto &state) {
+                if (step % RATIO != 0)
+                    return;
+                ublas::column(states, step / RATIO).assign(state);
+            };
+            solver_.solve(eqns_, store);
+        }
 
     public:
         template <typename vect>
         inline value_type operator()(vect const &p)
         {
             assert(p.size() == dim);
+            profiling::count(profiling::Event::lse_evaluation);
+            profiling::PhaseTimer timer(profiling::Phase::lse_evaluation);
             return lse(p);
         }
 
+        // LSE if it does not exceed bound (returns true), otherwise returns false as soon as the
+        // accumulated residual exceeds it and value is only the partial sum
+        template <typename vect>
+        bool bounded(vect const &p, const value_type bound, value_type &value)
+        {
+            assert(p.size() == dim);
+            profiling::count(profiling::Event::lse_evaluation);
+            profiling::PhaseTimer timer(profiling::Phase::lse_evaluation);
+            const value_type normalization = (value_type)(no_days_)*pop_size_squared_;
+            const value_type limit = bound * normalization;
+
+            eqns_.set_initial_condition(init_cond_);
+            eqns_.set_parameters(p);
+
+            value_type lse = 0.0;
+            auto accumulate = [this, &lse, limit](const size_type step, const auto &state) {
+                if (step % RATIO != 0)
+                    return true;
+                lse += pow(ublas::norm_2(ublas::column(prediction_, step / RATIO) - state), 2);
+                return lse <= limit; // nan stops as well
+            };
+            const bool within = solver_.solve(eqns_, accumulate);
+            value = lse / normalization;
+            profiling::count(profiling::Event::lse_solve);
+            if (!within)
+                profiling::count(profiling::Event::lse_bound_exceeded);
+#ifdef DLVL3
+            std::cout << "LSE: " << value << (within ? "" : " (bound exceeded)") << std::endl
+                      << std::endl;
+#endif
+            return within && value <= bound;
+        }
+
     private:
         template <typename vect>
         value_type lse(vect const &params)
+        {
+            return lse(params, eqns_, solver_);
+        };
+
+        // residual is accumulated while solving, only states at whole days are compared with observations
+        template <typename vect>
+        value_type lse(vect const &params, OdeSys_SIQRD<value_type, size_type> &eqns,
+                       ode::OdeSolver<SchemeType> &solver) const
         {
             assert(params.size() == dim);
-            assert((scratch_space_.size2() - 1) / (no_days_ - 1) == RATIO);
 
-            eqns_.set_initial_condition(init_cond_);
-            eqns_.set_parameters(params);
-            solver_.solve(eqns_, scratch_space_);
+            eqns.set_initial_condition(init_cond_);
+            eqns.set_parameters(params);
 
             value_type lse = 0.0;
-            size_type i = 0;
-            for (size_type day = 0; day < no_days_; day++)
-            {
-                auto x_ip = ublas::column(scratch_space_, i);
-                auto x_i = ublas::column(prediction_, day);
-                lse += pow(ublas::norm_2(x_i - x_ip), 2);
-
-                i += RATIO;
-            }
+            auto accumulate = [this, &lse](const size_type step, const auto &state) {
+                if (step % RATIO != 0)
+                    return;
+                lse += pow(ublas::norm_2(ublas::column(prediction_, step / RATIO) - state), 2);
+            };
+            solver.solve(eqns, accumulate);
+            profiling::count(profiling::Event::lse_solve);
 
             lse /= ((value_type)(no_days_)*pop_size_squared_);
 #ifdef DLVL3
@@ -131,13 +356,182 @@ target_functor
             return lse;
         };
 
+    public:
+        size_type no_residuals() const { return no_days_ * eqns_dim; }
+
+        // scaled differences of observations and solution, residual of compartment k at day d is r[d * 5 + k],
+        // LSE is the squared norm of r
+        template <typename vect, typename res_vect>
+        void residuals(vect const &p, res_vect &r)
+        {
+            assert(p.size() == dim);
+            assert(r.size() == no_residuals());
+            profiling::count(profiling::Event::lse_evaluation);
+            profiling::PhaseTimer timer(profiling::Phase::lse_evaluation);
+
+            eqns_.set_initial_condition(init_cond_);
+            eqns_.set_parameters(p);
+            const value_type scale = 1.0 / std::sqrt((value_type)(no_days_)*pop_size_squared_);
+            auto store = [this, &r, scale](const size_type step, const auto &state) {
+                if (step % RATIO != 0)
+                    return;
+                const size_type day = step / RATIO;
+                for (size_type k = 0; k < eqns_dim; k++)
+                    r[day * eqns_dim + k] = (prediction_(k, day) - state[k]) * scale;
+            };
+            solver_.solve(eqns_, store);
+            profiling::count(profiling::Event::lse_solve);
+        }
+
+        // residuals and their derivatives with respect to parameters (no_residuals x dim),
+        // from a single solve of the sensitivity equations
+        template <typename vect, typename res_vect, typename matrix_type>
+        void residual_jacobian(vect const &p, res_vect &r, matrix_type &jac)
+        {
+            assert(p.size() == dim);
+            assert(r.size() == no_residuals());
+            assert(jac.size1() == no_residuals() && jac.size2() == dim);
+            assert(ode::exact_sensitivity<SchemeType>::value);
+            profiling::count(profiling::Event::lse_gradient);
+            profiling::PhaseTimer timer(profiling::Phase::lse_gradient);
+
+            sens_eqns_.set_initial_condition(init_cond_);
+            sens_eqns_.set_parameters(p);
+            const value_type scale = 1.0 / std::sqrt((value_type)(no_days_)*pop_size_squared_);
+            auto store = [this, &r, &jac, scale](const size_type step, const auto &state) {
+                if (step % RATIO != 0)
+                    return;
+                const size_type day = step / RATIO;
+                for (size_type k = 0; k < eqns_dim; k++)
+                {
+                    r[day * eqns_dim + k] = (prediction_(k, day) - state[k]) * scale;
+                    for (size_type j = 0; j < dim; j++)
+                        jac(day * eqns_dim + k, j) = -state[(j + 1) * eqns_dim + k] * scale;
+                }
+            };
+            sens_solver_.solve(sens_eqns_, store);
+        }
+
+    public:
+        // LSE and its exact gradient, by adjoint method if set by set_gradient, by sensitivity equations otherwise
+        template <typename v1, typename v2>
+        value_type lse_gradient(v1 const &params, v2 &grad)
+        {
+            if constexpr (ode::has_adjoint<SchemeType>::value)
+            {
+                if (gradient_method_ == GradientMethod::adjoint)
+                    return adjoint_gradient(params, grad);
+            }
+            assert(ode::exact_sensitivity<SchemeType>::value);
+            return sensitivity_gradient(params, grad);
+        }
+
+    private:
+        // cost_type of AdjointSolver, LSE contribution of states at whole days
+        struct lse_cost
+        {
+            const LSE_siqrd &lse_;
+            const value_type normalization_;
+
+            template <typename vect>
+            value_type value(const size_type step, const vect &state) const
+            {
+                if (step % RATIO != 0)
+                    return 0.0;
+                return ublas::inner_prod(ublas::column(lse_.prediction_, step / RATIO) - state,
+                                         ublas::column(lse_.prediction_, step / RATIO) - state) /
+                       normalization_;
+            }
+            template <typename v1, typename v2>
+            void gradient(const size_type step, const v1 &state, v2 &adjoint) const
+            {
+                if (step % RATIO != 0)
+                    return;
+                noalias(adjoint) -= (2.0 / normalization_) * (ublas::column(lse_.prediction_, step / RATIO) - state);
+            }
+        };
+
+        // LSE and its exact gradient from a forward solve and a backward adjoint sweep
+        template <typename v1, typename v2>
+        value_type adjoint_gradient(v1 const &params, v2 &grad)
+        {
+            assert(params.size() == dim);
+            assert(grad.size() == dim);
+
+            eqns_.set_initial_condition(init_cond_);
+            eqns_.set_parameters(params);
+            lse_cost cost{*this, (value_type)(no_days_)*pop_size_squared_};
+            return adjoint_solver_.solve(eqns_, cost, grad);
+        }
+
+        // LSE and its exact gradient from a single solve of the state augmented with sensitivities
+        template <typename v1, typename v2>
+        value_type sensitivity_gradient(v1 const &params, v2 &grad)
+        {
+            assert(params.size() == dim);
+            assert(grad.size() == dim);
+
+            sens_eqns_.set_initial_condition(init_cond_);
+            sens_eqns_.set_parameters(params);
+
+            value_type lse = 0.0;
+            grad.clear();
+            auto accumulate = [this, &lse, &grad](const size_type step, const auto &state) {
+                if (step % RATIO != 0)
+                    return;
+                const size_type day = step / RATIO;
+                for (size_type k = 0; k < eqns_dim; k++)
+                {
+                    const value_type residual = prediction_(k, day) - state[k];
+                    lse += residual * residual;
+                    for (size_type j = 0; j < dim; j++)
+                    {
+                        grad[j] -= 2 * residual * state[(j + 1) * eqns_dim + k];
+                    }
+                }
+            };
+            sens_solver_.solve(sens_eqns_, accumulate);
+
+            const value_type normalization = (value_type)(no_days_)*pop_size_squared_;
+            grad /= normalization;
+            return lse / normalization;
+        }
+
     public:
         template <typename v1, typename v2>
         void gradient(v1 const &p, const value_type lse_0, v2 &grad)
         {
             assert(p.size() == dim);
             assert(grad.size() == dim);
+            profiling::count(profiling::Event::lse_gradient);
+            profiling::PhaseTimer timer(profiling::Phase::lse_gradient);
 
+            if (pool_)
+            {
+                parallel_gradient(p, lse_0, grad);
+            }
+            else if (gradient_method_ == GradientMethod::sensitivity || gradient_method_ == GradientMethod::adjoint)
+            {
+                lse_gradient(p, grad);
+            }
+            else if (gradient_method_ == GradientMethod::central_difference)
+            {
+                central_gradient(p, grad);
+            }
+            else
+            {
+                forward_gradient(p, lse_0, grad);
+            }
+#ifdef DLVL3
+            std::cout << "gradient of LSE: " << std::endl
+                      << grad << std::endl;
+#endif
+        }
+
+    private:
+        template <typename v1, typename v2>
+        void forward_gradient(v1 const &p, const value_type lse_0, v2 &grad)
+        {
             params_temp_.assign(p);
             params_temp_[0] += EPS;
             grad[0] = (lse(params_temp_) - lse_0) / EPS;
@@ -147,10 +541,41 @@ target_functor
                 params_temp_[i] += EPS;
                 grad[i] = (lse(params_temp_) - lse_0) / EPS;
             }
-#ifdef DLVL3
-            std::cout << "gradient of LSE: " << std::endl
-                      << grad << std::endl;
-#endif
+        }
+
+        template <typename v1, typename v2>
+        void central_gradient(v1 const &p, v2 &grad)
+        {
+            params_temp_.assign(p);
+            for (decltype(p.size()) i = 0; i < p.size(); i++)
+            {
+                params_temp_[i] = p[i] + EPS;
+                grad[i] = lse(params_temp_);
+                params_temp_[i] = p[i] - EPS;
+                grad[i] = (grad[i] - lse(params_temp_)) / (2 * EPS);
+                params_temp_[i] = p[i];
+            }
+        }
+
+        // every perturbed solve is a task, each worker thread solves in its own workspace
+        template <typename v1, typename v2>
+        void parallel_gradient(v1 const &p, const value_type lse_0, v2 &grad)
+        {
+            const bool central = gradient_method_ == GradientMethod::central_difference;
+            auto task = [this, &p, central](const size_type task, const size_type worker) {
+                workspace &ws = workspaces_[worker];
+                const size_type i = central ? task / 2 : task;
+                ws.params_temp_.assign(p);
+                ws.params_temp_[i] += (central && task % 2) ? -EPS : EPS;
+                perturbed_lse_[task] = lse(ws.params_temp_, ws.eqns_, ws.solver_);
+            };
+            pool_->run(central ? 2 * dim : dim, task);
+
+            for (size_type i = 0; i < dim; i++)
+            {
+                grad[i] = central ? (perturbed_lse_[2 * i] - perturbed_lse_[2 * i + 1]) / (2 * EPS)
+                                  : (perturbed_lse_[i] - lse_0) / EPS;
+            }
         }
     };
 } // namespace siqrd
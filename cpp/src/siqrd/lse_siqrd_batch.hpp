@@ -0,0 +1,150 @@
+#ifndef LSE_SIQRD_BATCH_HPP
+#define LSE_SIQRD_BATCH_HPP
+/*
+    Least square error calculation of SIQRD equations for many parameter sets at once.
+    Parameter sets are integrated together in lanes of a batched scheme.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <numeric>
+#include <string>
+
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "../ode/batchSolver.hpp"
+#include "observations.hpp"
+#include "lse_siqrd.hpp" // substeps_per_day
+#include "../profiling/counters.hpp"
+
+namespace siqrd
+{
+
+    /*
+    pases BatchSchemeType concept to BatchSolver template
+
+////Uses concepts:
+BatchSchemeType
+    constructor:
+        BatchSchemeType(const value_type steps, const value_type final_time)
+    member types:
+        size_type, value_type, state_type, system_type
+    member functions:
+        void time_step(const BatchOdeSystem &system, const state_type &old_time, state_type &new_time)
+    static variables:
+        size_type dim
+        size_type lanes
+        char[] method_name
+    */
+    template <typename BatchSchemeType>
+    class LSE_siqrd_batch
+    {
+    public:
+        typedef typename std::enable_if<std::is_floating_point<typename BatchSchemeType::value_type>::value,
+                                        typename BatchSchemeType::value_type>::type value_type;
+        typedef typename std::enable_if<std::is_integral<typename BatchSchemeType::size_type>::value,
+                                        typename BatchSchemeType::size_type>::type size_type;
+        typedef typename BatchSchemeType::state_type state_type;
+        typedef BatchSchemeType method;
+        typedef typename BatchSchemeType::system_type BatchOdeSystem;
+
+    private:
+        size_type no_days_;
+        Observations<value_type> observations_;
+        // view of observations_ data, no copy
+        ublas::matrix<value_type, ublas::column_major, ublas::array_adaptor<value_type>> prediction_;
+        ublas::vector<value_type> init_cond_;
+        value_type pop_size_squared_;
+
+        static const size_type constexpr RATIO = substeps_per_day<BatchSchemeType>::value; // same as LSE_siqrd
+
+        BatchOdeSystem eqns_;
+        ode::BatchSolver<BatchSchemeType> solver_;
+
+    private:
+        const static size_type constexpr eqns_dim = BatchOdeSystem::dim;
+        const static size_type constexpr lanes = BatchOdeSystem::lanes;
+
+    public:
+        const static size_type constexpr dim = BatchOdeSystem::no_params;
+
+    public:
+        LSE_siqrd_batch(const std::string &observation_file) : observations_(observation_file)
+        {
+            assert(observations_.dim() == eqns_dim);
+            no_days_ = observations_.no_days();
+            prediction_.resize(eqns_dim, no_days_, false);
+            prediction_.data().resize(eqns_dim * no_days_, observations_.data());
+            solver_ = decltype(solver_)((no_days_ - 1) * RATIO, (value_type)(no_days_ - 1));
+
+            init_cond_ = ublas::column(prediction_, 0);
+            eqns_.set_initial_condition(init_cond_);
+            pop_size_squared_ = std::accumulate(init_cond_.begin(), init_cond_.end(), 0.0);
+            pop_size_squared_ *= pop_size_squared_;
+        };
+        ~LSE_siqrd_batch(){};
+
+    public:
+        // params has one parameter set per column, lse receives one value per column
+        template <typename matrix_type, typename vect>
+        void operator()(const matrix_type &params, vect &lse)
+        {
+            assert(params.size1() == dim);
+            assert(params.size2() == lse.size());
+            profiling::count(profiling::Event::lse_evaluation, params.size2());
+            profiling::PhaseTimer timer(profiling::Phase::lse_evaluation);
+
+            const size_type no_sets = params.size2();
+            value_type lane_lse[lanes];
+            for (size_type first = 0; first < no_sets; first += lanes)
+            {
+                // a partially filled last batch repeats its last parameter set in the unused lanes
+                for (size_type k = 0; k < lanes; k++)
+                {
+                    eqns_.set_parameters(k, ublas::column(params, std::min(first + k, no_sets - 1)));
+                }
+                lse_lanes(lane_lse);
+                for (size_type k = 0; k < lanes && first + k < no_sets; k++)
+                {
+                    lse[first + k] = lane_lse[k];
+                }
+            }
+        }
+
+    private:
+        void lse_lanes(value_type (&lse)[lanes])
+        {
+            std::fill(lse, lse + lanes, 0.0);
+            auto accumulate = [this, &lse](const size_type step, const state_type &state) {
+                if (step % RATIO != 0)
+                    return;
+                const size_type day = step / RATIO;
+                for (size_type i = 0; i < eqns_dim; i++)
+                {
+                    const value_type observed = prediction_(i, day);
+                    const value_type *row = &state(i, 0);
+                    for (size_type k = 0; k < lanes; k++)
+                    {
+                        lse[k] += (observed - row[k]) * (observed - row[k]);
+                    }
+                }
+            };
+            solver_.solve(eqns_, accumulate);
+
+            for (size_type k = 0; k < lanes; k++)
+            {
+                lse[k] /= ((value_type)(no_days_)*pop_size_squared_);
+            }
+#ifdef DLVL3
+            std::cout << "Batch LSE of lane 0: " << lse[0] << std::endl
+                      << std::endl;
+#endif
+        }
+    };
+} // namespace siqrd
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef OBSERVATIONS_HPP
+#define OBSERVATIONS_HPP
+/*
+    Observations of SIQRD compartments, read from text '.in' files or binary '.obs' files.
+    Binary files with matching floating point type are memory mapped and used without copying.
+
+    Text format:   no_days dim, then one line per day: time value_1 ... value_dim
+    Binary format: header (magic "SIQRDOBS", value type tag and size, no_days, dim) followed by no_days
+                   contiguous columns of dim values (column major dim x no_days), native byte order
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace siqrd
+{
+    // stored floating point type, float and long double of same size are told apart
+    enum class ValueTag : std::uint32_t
+    {
+        float_type = 1,
+        double_type = 2,
+        long_double_type = 3
+    };
+
+    template <typename Type>
+    constexpr ValueTag value_tag()
+    {
+        static_assert(std::is_floating_point<Type>::value, "observations are floating point");
+        return std::is_same<Type, float>::value ? ValueTag::float_type
+                                                : std::is_same<Type, double>::value ? ValueTag::double_type : ValueTag::long_double_type;
+    }
+
+    struct ObservationHeader
+    {
+        char magic[8];            // "SIQRDOBS"
+        ValueTag dtype;           // stored floating point type
+        std::uint32_t value_size; // its sizeof, long double differs between platforms; keeps data aligned to 16 bytes
+        std::uint64_t no_days, dim;
+    };
+    static_assert(sizeof(ObservationHeader) == 32, "observation header has to be 32 bytes");
+
+    static const char constexpr observation_magic[8] = {'S', 'I', 'Q', 'R', 'D', 'O', 'B', 'S'};
+
+    // binary file of name in folder if it exists and is not older than text file, text file otherwise,
+    // so that editing the text file without converting it again is not silently ignored
+    inline std::string observationFile(const std::string &folder, const std::string &name)
+    {
+        const std::string binary = folder + name + ".obs", text = folder + name + ".in";
+        struct stat binary_status, text_status;
+        if (stat(binary.c_str(), &binary_status) != 0)
+            return text;
+        if (stat(text.c_str(), &text_status) != 0)
+            return binary;
+        if (binary_status.st_mtim.tv_sec != text_status.st_mtim.tv_sec)
+            return binary_status.st_mtim.tv_sec > text_status.st_mtim.tv_sec ? binary : text;
+        return binary_status.st_mtim.tv_nsec >= text_status.st_mtim.tv_nsec ? binary : text;
+    }
+
+    /*
+Satisfies concepts:
+Observations
+    member types:
+        size_type, value_type
+    member functions:
+        size_type no_days() const
+        size_type dim() const
+        value_type *data()                         column major dim x no_days
+        value_type operator()(size_type i, size_type day) const
+        bool mapped() const
+        bool good() const                          false if file could not be read (message is printed)
+    */
+    template <typename Type = double>
+    class Observations
+    {
+    public:
+        typedef Type value_type;
+        typedef std::size_t size_type;
+
+    private:
+        size_type no_days_, dim_;
+        value_type *data_;
+        void *map_; // whole file if mapped, data_ points behind its header
+        size_type map_size_;
+        std::vector<value_type> buffer_; // data of text files and of binary files with other value type
+
+    public:
+        Observations() : no_days_(0), dim_(0), data_(nullptr), map_(nullptr), map_size_(0){};
+        Observations(const std::string &file_name) : Observations()
+        {
+#ifdef DLVL1
+            std::cout << "Reading observations from " << file_name << "...       ";
+#endif
+            std::ifstream file(file_name, std::ios::binary);
+            if (!file)
+            {
+                std::cerr << "Cannot open observation file " << file_name << std::endl;
+                return;
+            }
+            char magic[sizeof(observation_magic)] = {};
+            file.read(magic, sizeof(magic));
+            file.close();
+            const bool read = std::memcmp(magic, observation_magic, sizeof(magic)) == 0 ? read_binary(file_name)
+                                                                                        : read_text(file_name);
+            if (!read)
+                clear();
+#ifdef DLVL1
+            std::cout << "done" << (mapped() ? " (mapped)." : ".") << std::endl;
+#endif
+        };
+        ~Observations() { unmap(); };
+
+        Observations(const Observations &) = delete;
+        Observations &operator=(const Observations &) = delete;
+
+    public:
+        size_type no_days() const { return no_days_; }
+        size_type dim() const { return dim_; }
+        value_type *data() { return data_; }
+        const value_type *data() const { return data_; }
+        bool mapped() const { return map_ != nullptr; }
+        bool good() const { return no_days_ > 0 && dim_ > 0; }
+
+        value_type operator()(const size_type i, const size_type day) const
+        {
+            assert(i < dim_ && day < no_days_);
+            return data_[day * dim_ + i];
+        }
+
+        // writes binary format, times are not stored (day i is at time i);
+        // returns false after printing a message if the file cannot be (completely) written
+        bool write_binary(const std::string &file_name) const
+        {
+            ObservationHeader header;
+            std::memcpy(header.magic, observation_magic, sizeof(header.magic));
+            header.dtype = value_tag<value_type>();
+            header.value_size = sizeof(value_type);
+            header.no_days = no_days_;
+            header.dim = dim_;
+            std::ofstream file(file_name, std::ios::binary);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(data_), no_days_ * dim_ * sizeof(value_type));
+            file.close();
+            if (!file)
+            {
+                std::cerr << "Cannot write observation file " << file_name << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        // readers return false after printing what is wrong with the file
+        bool read_text(const std::string &file_name)
+        {
+            std::ifstream file(file_name);
+            file >> no_days_ >> dim_;
+            if (!file)
+            {
+                std::cerr << "Cannot read header of observation file " << file_name << std::endl;
+                return false;
+            }
+            buffer_.resize(no_days_ * dim_);
+            value_type unused;
+            for (size_type day = 0; day < no_days_; day++)
+            {
+                file >> unused;
+                for (size_type i = 0; i < dim_; i++)
+                {
+                    file >> buffer_[day * dim_ + i];
+                }
+            }
+            if (!file)
+            {
+                std::cerr << "Observation file " << file_name << " is truncated or not a number" << std::endl;
+                return false;
+            }
+            data_ = buffer_.data();
+            return true;
+        }
+
+        bool read_binary(const std::string &file_name)
+        {
+            const int fd = open(file_name.c_str(), O_RDONLY);
+            struct stat status;
+            if (fd < 0 || fstat(fd, &status) != 0 || (size_type)status.st_size < sizeof(ObservationHeader))
+            {
+                std::cerr << "Cannot read observation file " << file_name << std::endl;
+                if (fd >= 0)
+                    close(fd);
+                return false;
+            }
+            // private writable mapping, pages are shared with the page cache until written to (only by bootstrap replicates)
+            map_size_ = status.st_size;
+            map_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (map_ == MAP_FAILED)
+            {
+                map_ = nullptr;
+                std::cerr << "Cannot map observation file " << file_name << std::endl;
+                return false;
+            }
+
+            ObservationHeader header;
+            std::memcpy(&header, map_, sizeof(header));
+            no_days_ = header.no_days;
+            dim_ = header.dim;
+            if (stored_size(header.dtype) == 0)
+            {
+                std::cerr << "Unknown value type in observation file " << file_name << " (convert it again)" << std::endl;
+                return false;
+            }
+            if (header.value_size != stored_size(header.dtype))
+            {
+                std::cerr << "Observation file " << file_name << " was written with " << header.value_size
+                          << " byte values of a type that has " << stored_size(header.dtype) << " bytes here" << std::endl;
+                return false;
+            }
+            if (map_size_ != sizeof(header) + no_days_ * dim_ * header.value_size)
+            {
+                std::cerr << "Observation file " << file_name << " is truncated" << std::endl;
+                return false;
+            }
+
+            char *stored = static_cast<char *>(map_) + sizeof(header);
+            if (header.dtype == value_tag<value_type>())
+            {
+                data_ = reinterpret_cast<value_type *>(stored);
+                return true;
+            }
+            // other floating point type, converted to a copy
+            buffer_.resize(no_days_ * dim_);
+            for (size_type k = 0; k < buffer_.size(); k++)
+            {
+                buffer_[k] = convert(stored + k * header.value_size, header.dtype);
+            }
+            data_ = buffer_.data();
+            unmap();
+            return true;
+        }
+
+        // sizeof of tagged type on this platform, 0 for unknown tag
+        static std::uint32_t stored_size(const ValueTag dtype)
+        {
+            switch (dtype)
+            {
+            case ValueTag::float_type:
+                return sizeof(float);
+            case ValueTag::double_type:
+                return sizeof(double);
+            case ValueTag::long_double_type:
+                return sizeof(long double);
+            }
+            return 0;
+        }
+
+        static value_type convert(const char *stored, const ValueTag dtype)
+        {
+            if (dtype == ValueTag::float_type)
+                return load<float>(stored);
+            if (dtype == ValueTag::double_type)
+                return load<double>(stored);
+            return load<long double>(stored);
+        }
+
+        template <typename stored_type>
+        static value_type load(const char *stored)
+        {
+            stored_type value;
+            std::memcpy(&value, stored, sizeof(value));
+            return (value_type)value;
+        }
+
+        // empty observations after failed read
+        void clear()
+        {
+            unmap();
+            buffer_.clear();
+            data_ = nullptr;
+            no_days_ = dim_ = 0;
+        }
+
+        void unmap()
+        {
+            if (map_)
+                munmap(map_, map_size_);
+            map_ = nullptr;
+        }
+    };
+} // namespace siqrd
+#endif
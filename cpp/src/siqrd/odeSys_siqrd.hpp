@@ -7,12 +7,16 @@
 #include <cassert>
 #include <cmath>
 #include <fstream>
+#include <iostream>
+#include <limits>
 #include <string>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 namespace ublas = boost::numeric::ublas;
 
+#include "../profiling/counters.hpp"
+
 namespace siqrd
 {
     /*
@@ -45,6 +49,9 @@ OdeSystem
         static const size_type dim = 5;
         static const size_type no_params = 5;
 
+        // fixed size, returned by value without heap allocation
+        typedef ublas::c_vector<value_type, dim> state_type;
+
     public:
         //default safe constructor
         OdeSys_SIQRD()
@@ -72,6 +79,12 @@ OdeSystem
                 I0_ = std::numeric_limits<value_type>::quiet_NaN();
 #endif
             }
+            // unreadable file leaves parameters NaN as the default constructor does
+            if (!file)
+            {
+                std::cerr << "Cannot read parameter file " << paramsFile << std::endl;
+                alpha_ = beta_ = gamma_ = delta_ = mu_ = S0_ = I0_ = std::numeric_limits<value_type>::quiet_NaN();
+            }
 
 #ifdef DLVL1
             std::cout << "done." << std::endl;
@@ -94,7 +107,7 @@ OdeSystem
 
     public:
         template <typename vector>
-        void set_initial_condition(vector v)
+        void set_initial_condition(const vector &v)
         {
             assert(dim == v.size());
             S0_ = v[0];
@@ -106,7 +119,7 @@ OdeSystem
 
     public:
         template <typename vector>
-        void set_parameters(vector v)
+        void set_parameters(const vector &v)
         {
             assert(dim == v.size());
             alpha_ = v[0];
@@ -127,9 +140,9 @@ OdeSystem
         }
 
     public:
-        ublas::vector<value_type> initial_condition() const
+        state_type initial_condition() const
         {
-            ublas::vector<value_type> ret(dim);
+            state_type ret(dim);
             ret[0] = S0_;
             ret[1] = I0_;
             ret[2] = Q0_;
@@ -140,10 +153,11 @@ OdeSystem
 
     public:
         template <typename vector_type>
-        ublas::vector<value_type> operator()(const vector_type &variables_vector) const
+        state_type operator()(const vector_type &variables_vector) const
         {
             assert((size_type)variables_vector.size() == dim);
-            ublas::vector<value_type> ret_vector(dim);
+            profiling::count(profiling::Event::rhs);
+            state_type ret_vector(dim);
             value_type S = variables_vector[0], I = variables_vector[1],
                        Q = variables_vector[2], R = variables_vector[3];
             ret_vector[0] = fS(S, I, R);
@@ -160,6 +174,7 @@ OdeSystem
         {
             assert((size_type)variables_vector.size() == dim);
             assert((size_type)return_vector.size() == dim);
+            profiling::count(profiling::Event::rhs);
             value_type S = variables_vector[0], I = variables_vector[1],
                        Q = variables_vector[2], R = variables_vector[3];
             return_vector[0] = fS(S, I, R);
@@ -176,6 +191,7 @@ OdeSystem
             assert((size_type)variables_vector.size() == dim);
             assert(jac_matrix.size1() == variables_vector.size());
             assert(jac_matrix.size1() == jac_matrix.size2());
+            profiling::count(profiling::Event::jacobian);
             value_type S = variables_vector[0], I = variables_vector[1], R = variables_vector[3];
 
             jac_matrix.clear();
@@ -197,6 +213,37 @@ OdeSystem
             jac_matrix(3, 3) = (-1) * mu_;
         };
 
+    public:
+        // derivatives of right hand side with respect to parameters, same ordering as set_parameters
+        template <typename vector_type, typename matrix_type>
+        void parameter_jacobian(const vector_type &variables_vector, matrix_type &jac_matrix) const
+        {
+            assert((size_type)variables_vector.size() == dim);
+            assert(jac_matrix.size1() == dim);
+            assert(jac_matrix.size2() == no_params);
+            value_type S = variables_vector[0], I = variables_vector[1],
+                       Q = variables_vector[2], R = variables_vector[3];
+
+            jac_matrix.clear();
+            // alpha
+            jac_matrix(1, 0) = -I;
+            jac_matrix(2, 0) = -Q;
+            jac_matrix(4, 0) = I + Q;
+            // beta
+            jac_matrix(0, 1) = -S * (I / (S + I + R));
+            jac_matrix(1, 1) = I * (S / (S + I + R));
+            // gamma
+            jac_matrix(1, 2) = -I;
+            jac_matrix(2, 2) = -Q;
+            jac_matrix(3, 2) = I + Q;
+            // delta
+            jac_matrix(1, 3) = -I;
+            jac_matrix(2, 3) = I;
+            // mu
+            jac_matrix(0, 4) = R;
+            jac_matrix(3, 4) = -R;
+        };
+
     private: // functions for SIQRD equations evluation
         inline value_type fS(const value_type S, const value_type I, const value_type R) const
         {
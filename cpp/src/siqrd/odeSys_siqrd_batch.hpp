@@ -0,0 +1,131 @@
+#ifndef ODE_SYSTEM_SIQRD_BATCH_HPP
+#define ODE_SYSTEM_SIQRD_BATCH_HPP
+/*
+    Class representing a batch of independent SIQRD systems, each lane with its own parameters.
+    State is stored structure-of-arrays (compartment x lane), so evaluation vectorizes across lanes.
+*/
+
+#include <cassert>
+#include <cmath>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "../profiling/counters.hpp"
+
+namespace siqrd
+{
+    /*
+Satisfies concept;
+BatchOdeSystem
+    member types:
+        size_type, value_type, state_type (dim x lanes, row major)
+    member functions:
+        void initial_condition(state_type &state) const
+        void operator()(const state_type &variables, state_type &return_state)
+    static variables:
+        size_type dim
+        size_type lanes
+    */
+
+    template <typename Type = double, std::size_t Lanes = 8, typename SizeType = typename ublas::vector<Type>::size_type>
+    class OdeSys_SIQRD_batch
+    {
+    public:
+        typedef typename std::enable_if<std::is_integral<SizeType>::value, SizeType>::type size_type;
+        typedef typename std::enable_if<std::is_floating_point<Type>::value, Type>::type value_type;
+
+    public:
+        static const size_type dim = 5;
+        static const size_type no_params = 5;
+        static const size_type lanes = Lanes;
+
+        // one row per compartment (or parameter), lanes are contiguous within a row
+        typedef ublas::bounded_matrix<value_type, dim, lanes, ublas::row_major> state_type;
+        typedef ublas::bounded_matrix<value_type, no_params, lanes, ublas::row_major> params_type;
+
+    private:
+        params_type params_; // rows: alpha, beta, gamma, delta, mu
+        value_type S0_, I0_, Q0_, R0_, D0_;
+
+    public:
+        //default safe constructor
+        OdeSys_SIQRD_batch()
+        {
+            params_.assign(ublas::scalar_matrix<value_type>(no_params, lanes, std::numeric_limits<value_type>::quiet_NaN()));
+            S0_ = I0_ = Q0_ = R0_ = D0_ = std::numeric_limits<value_type>::quiet_NaN();
+        }
+        ~OdeSys_SIQRD_batch(){};
+
+    public:
+        // same initial condition for all lanes
+        template <typename vector>
+        void set_initial_condition(const vector &v)
+        {
+            assert(dim == v.size());
+            S0_ = v[0];
+            I0_ = v[1];
+            Q0_ = v[2];
+            R0_ = v[3];
+            D0_ = v[4];
+        }
+
+    public:
+        // same ordering as OdeSys_SIQRD::set_parameters
+        template <typename vector>
+        void set_parameters(const size_type lane, const vector &v)
+        {
+            assert(lane < lanes);
+            assert(no_params == v.size());
+            for (size_type i = 0; i < no_params; i++)
+            {
+                params_(i, lane) = v[i];
+            }
+        }
+        ublas::vector<value_type> parameters(const size_type lane) const
+        {
+            assert(lane < lanes);
+            return ublas::column(params_, lane);
+        }
+
+    public:
+        void initial_condition(state_type &state) const
+        {
+            const value_type init[dim] = {S0_, I0_, Q0_, R0_, D0_};
+            for (size_type i = 0; i < dim; i++)
+            {
+                value_type *row = &state(i, 0);
+                for (size_type k = 0; k < lanes; k++)
+                {
+                    row[k] = init[i];
+                }
+            }
+        }
+
+    public:
+        void operator()(const state_type &variables, state_type &return_state) const
+        {
+            profiling::count(profiling::Event::rhs);
+            const value_type *S = &variables(0, 0), *I = &variables(1, 0),
+                             *Q = &variables(2, 0), *R = &variables(3, 0);
+            value_type *dS = &return_state(0, 0), *dI = &return_state(1, 0), *dQ = &return_state(2, 0),
+                       *dR = &return_state(3, 0), *dD = &return_state(4, 0);
+            const value_type *alpha = &params_(0, 0), *beta = &params_(1, 0), *gamma = &params_(2, 0),
+                             *delta = &params_(3, 0), *mu = &params_(4, 0);
+
+            // same formulas as OdeSys_SIQRD::fS .. fD, one lane per iteration
+            for (size_type k = 0; k < lanes; k++)
+            {
+                const value_type inv_N = 1.0 / (S[k] + I[k] + R[k]);
+                dS[k] = (-beta[k] * S[k] * (I[k] * inv_N) + mu[k] * R[k]);
+                dI[k] = I[k] * (beta[k] * (S[k] * inv_N) - gamma[k] - delta[k] - alpha[k]);
+                dQ[k] = delta[k] * I[k] - (gamma[k] + alpha[k]) * Q[k];
+                dR[k] = gamma[k] * (I[k] + Q[k]) - mu[k] * R[k];
+                dD[k] = alpha[k] * (I[k] + Q[k]);
+            }
+        }
+    };
+} // namespace siqrd
+#endif
@@ -0,0 +1,357 @@
+#ifndef ODE_SYSTEM_SIQRD_META_HPP
+#define ODE_SYSTEM_SIQRD_META_HPP
+/*
+    Class representing a metapopulation of Regions SIQRD populations coupled by sparse mobility.
+    Susceptible, infected and recovered move between connected regions, quarantined and dead do not.
+    State is stored compartment by compartment (S of all regions, then I, ...), so the local SIQRD kernel
+    runs over contiguous regions and vectorizes, jacobian is a CsrMatrix (dim = 5 * Regions).
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "../ode/csrMatrix.hpp"
+#include "../ode/jacobianStructure.hpp"
+#include "../profiling/counters.hpp"
+
+namespace siqrd
+{
+    // (from, to, rate) - fraction of mobile compartments of region from moving to region to per unit time
+    typedef std::tuple<std::size_t, std::size_t, double> mobility_link;
+
+    // every region exchanges rate with its neighbours on a ring
+    inline std::vector<mobility_link> ringMobility(const std::size_t no_regions, const double rate)
+    {
+        std::vector<mobility_link> links;
+        for (std::size_t r = 0; r < no_regions && no_regions > 1; r++)
+        {
+            links.emplace_back(r, (r + 1) % no_regions, rate);
+            links.emplace_back((r + 1) % no_regions, r, rate);
+        }
+        return links;
+    }
+
+    // false with message if a link connects regions outside of 0 .. no_regions - 1 or its rate is not a nonnegative number
+    inline bool validMobility(const std::vector<mobility_link> &links, const std::size_t no_regions, const std::string &source)
+    {
+        for (std::size_t k = 0; k < links.size(); k++)
+        {
+            const auto &link = links[k];
+            if (std::get<0>(link) >= no_regions || std::get<1>(link) >= no_regions || !(std::get<2>(link) >= 0.0) ||
+                !std::isfinite(std::get<2>(link)))
+            {
+                std::cerr << "Invalid mobility link " << k + 1 << " of " << source << ": " << std::get<0>(link) << " "
+                          << std::get<1>(link) << " " << std::get<2>(link) << " (regions 0 - " << no_regions - 1
+                          << ", nonnegative rate)" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // one link per line: from to rate, exits with message on unreadable file, malformed line or invalid link
+    inline std::vector<mobility_link> readMobility(const std::string &mobility_file, const std::size_t no_regions)
+    {
+        std::ifstream file(mobility_file);
+        if (!file)
+        {
+            std::cerr << "Cannot open mobility file " << mobility_file << std::endl;
+            std::exit(1);
+        }
+        std::vector<mobility_link> links;
+        long long from, to;
+        double rate;
+        while (file >> from >> to >> rate)
+        {
+            if (from < 0 || to < 0)
+            {
+                std::cerr << "Negative region in line " << links.size() + 1 << " of mobility file " << mobility_file << std::endl;
+                std::exit(1);
+            }
+            links.emplace_back(from, to, rate);
+        }
+        if (!file.eof())
+        {
+            std::cerr << "Mobility file " << mobility_file << " has malformed line " << links.size() + 1 << std::endl;
+            std::exit(1);
+        }
+        if (!validMobility(links, no_regions, mobility_file))
+            std::exit(1);
+        return links;
+    }
+
+    /*
+Satisfies concept;
+OdeSystem
+    member types:
+        size_type, value_type, jacobian_structure (sparse_jacobian)
+    member functions:
+        vector_type initial_condition() const
+        vector_type operator()( vector_type )
+        void operator()(const v1 &variables_vector, v2 &return_vector)
+        void jacobian()( variables, &CsrMatrix )      sets pattern of the system if the matrix has another one
+    static variables:
+        size_type dim
+    */
+    template <std::size_t Regions, typename Type = double, typename SizeType = typename ublas::vector<Type>::size_type>
+    class OdeSys_SIQRD_meta
+    {
+    public:
+        typedef typename std::enable_if<std::is_integral<SizeType>::value, SizeType>::type size_type;
+        typedef typename std::enable_if<std::is_floating_point<Type>::value, Type>::type value_type;
+        typedef ode::sparse_jacobian jacobian_structure;
+
+    public:
+        static const size_type regions = Regions;
+        static const size_type compartments = 5;
+        static const size_type dim = compartments * Regions;
+        static const size_type no_params = 5;
+
+        typedef ublas::c_vector<value_type, dim> state_type;
+
+    private:
+        value_type alpha_, beta_, gamma_, delta_, mu_;
+        state_type init_;
+        // incoming mobility, row r holds rates from regions s to r, outflow_[s] is the total rate leaving s
+        ode::CsrMatrix<value_type, size_type> mobility_;
+        std::vector<value_type> outflow_;
+        std::vector<std::vector<size_type>> pattern_; // columns of jacobian rows
+
+        static const constexpr bool mobile[compartments] = {true, true, false, true, false};
+
+    public:
+        //default safe constructor
+        OdeSys_SIQRD_meta() : init_(dim)
+        {
+            alpha_ = beta_ = gamma_ = delta_ = mu_ = std::numeric_limits<value_type>::quiet_NaN();
+            std::fill(init_.begin(), init_.end(), std::numeric_limits<value_type>::quiet_NaN());
+            set_mobility({});
+        }
+        // parameters and S0, I0 from file (same format as OdeSys_SIQRD), every region starts with S0 susceptible,
+        // I0 infected are placed into region seed_region only
+        OdeSys_SIQRD_meta(const std::string &paramsFile, const std::vector<mobility_link> &links, const size_type seed_region = 0)
+            : init_(dim)
+        {
+            if (seed_region >= Regions)
+            {
+                std::cerr << "Seed region " << seed_region << " is not one of " << Regions << " regions" << std::endl;
+                std::exit(1);
+            }
+            std::ifstream file(paramsFile);
+            value_type S0, I0;
+            file >> beta_ >> mu_ >> gamma_ >> alpha_ >> delta_ >> S0 >> I0;
+            if (!file)
+            {
+                std::cerr << "Cannot read parameters from " << paramsFile << std::endl;
+                std::exit(1);
+            }
+            std::fill(init_.begin(), init_.end(), 0.0);
+            std::fill(init_.begin(), init_.begin() + Regions, S0);
+            init_[Regions + seed_region] = I0;
+            set_mobility(links);
+        }
+        ~OdeSys_SIQRD_meta(){};
+
+    public:
+        template <typename vector>
+        void set_initial_condition(const vector &v)
+        {
+            assert(dim == v.size());
+            init_.assign(v);
+        }
+        state_type initial_condition() const { return init_; }
+
+        // same ordering as OdeSys_SIQRD::set_parameters, shared by all regions
+        template <typename vector>
+        void set_parameters(const vector &v)
+        {
+            assert(no_params == v.size());
+            alpha_ = v[0];
+            beta_ = v[1];
+            gamma_ = v[2];
+            delta_ = v[3];
+            mu_ = v[4];
+        }
+        ublas::vector<value_type> parameters() const
+        {
+            ublas::vector<value_type> ret(no_params);
+            ret[0] = alpha_;
+            ret[1] = beta_;
+            ret[2] = gamma_;
+            ret[3] = delta_;
+            ret[4] = mu_;
+            return ret;
+        }
+
+        // replaces mobility, links between the same pair of regions add up, exits with message on invalid link
+        void set_mobility(const std::vector<mobility_link> &links)
+        {
+            if (!validMobility(links, Regions, "mobility links"))
+                std::exit(1);
+            std::vector<std::vector<size_type>> incoming(Regions);
+            for (const auto &link : links)
+            {
+                if (std::get<0>(link) != std::get<1>(link))
+                    incoming[std::get<1>(link)].push_back(std::get<0>(link));
+            }
+            for (auto &row : incoming)
+            {
+                std::sort(row.begin(), row.end());
+                row.erase(std::unique(row.begin(), row.end()), row.end());
+            }
+            mobility_.set_pattern(Regions, incoming);
+            outflow_.assign(Regions, 0.0);
+            for (const auto &link : links)
+            {
+                if (std::get<0>(link) == std::get<1>(link))
+                    continue;
+                mobility_(std::get<1>(link), std::get<0>(link)) += std::get<2>(link);
+                outflow_[std::get<0>(link)] += std::get<2>(link);
+            }
+            build_pattern();
+        }
+
+    public:
+        template <typename vector_type>
+        state_type operator()(const vector_type &variables_vector) const
+        {
+            state_type ret_vector(dim);
+            (*this)(variables_vector, ret_vector);
+            return ret_vector;
+        }
+
+        // vectors have to be contiguous (c_vector, vector or column of a column major matrix)
+        template <typename v1, typename v2>
+        void operator()(const v1 &variables_vector, v2 &return_vector) const
+        {
+            assert((size_type)variables_vector.size() == dim);
+            assert((size_type)return_vector.size() == dim);
+            assert(&variables_vector[dim - 1] == &variables_vector[0] + dim - 1);
+            assert(&return_vector[dim - 1] == &return_vector[0] + dim - 1);
+            profiling::count(profiling::Event::rhs);
+            evaluate(&variables_vector[0], &return_vector[0]);
+        }
+
+        template <typename vector_type>
+        void jacobian(const vector_type &variables_vector, ode::CsrMatrix<value_type, size_type> &jac_matrix) const
+        {
+            assert((size_type)variables_vector.size() == dim);
+            profiling::count(profiling::Event::jacobian);
+            // set_mobility may have changed the pattern since the matrix was filled last time
+            if (!jac_matrix.has_pattern(pattern_))
+                jac_matrix.set_pattern(dim, pattern_);
+            assert(jac_matrix.size1() == dim);
+            jac_matrix.clear();
+
+            // same derivatives as OdeSys_SIQRD::jacobian in every region
+            for (size_type r = 0; r < Regions; r++)
+            {
+                const value_type S = variables_vector[r], I = variables_vector[Regions + r], R = variables_vector[3 * Regions + r];
+                const value_type inv_N = 1.0 / (S + I + R), SI_N2 = beta_ * S * I * inv_N * inv_N;
+                const size_type s = r, i = Regions + r, q = 2 * Regions + r, rr = 3 * Regions + r, d = 4 * Regions + r;
+                jac_matrix(s, s) = -beta_ * I * inv_N + SI_N2;
+                jac_matrix(s, i) = -beta_ * S * inv_N + SI_N2;
+                jac_matrix(s, rr) = mu_ + SI_N2;
+                jac_matrix(i, s) = beta_ * I * inv_N - SI_N2;
+                jac_matrix(i, i) = -SI_N2 + beta_ * S * inv_N - gamma_ - delta_ - alpha_;
+                jac_matrix(i, rr) = -SI_N2;
+                jac_matrix(q, i) = delta_;
+                jac_matrix(q, q) = -(gamma_ + alpha_);
+                jac_matrix(rr, i) = gamma_;
+                jac_matrix(rr, q) = gamma_;
+                jac_matrix(rr, rr) = -mu_;
+                jac_matrix(d, i) = alpha_;
+                jac_matrix(d, q) = alpha_;
+            }
+            for (size_type c = 0; c < compartments; c++)
+            {
+                if (!mobile[c])
+                    continue;
+                for (size_type r = 0; r < Regions; r++)
+                {
+                    jac_matrix(c * Regions + r, c * Regions + r) -= outflow_[r];
+                    for (size_type p = mobility_.row_start()[r]; p < mobility_.row_start()[r + 1]; p++)
+                        jac_matrix(c * Regions + r, c * Regions + mobility_.columns()[p]) += mobility_.values()[p];
+                }
+            }
+        }
+
+    private:
+        void evaluate(const value_type *x, value_type *f) const
+        {
+            const value_type *S = x, *I = x + Regions, *Q = x + 2 * Regions, *R = x + 3 * Regions;
+            value_type *dS = f, *dI = f + Regions, *dQ = f + 2 * Regions, *dR = f + 3 * Regions, *dD = f + 4 * Regions;
+
+            // same formulas as OdeSys_SIQRD::fS .. fD, one region per iteration
+            for (size_type r = 0; r < Regions; r++)
+            {
+                const value_type inv_N = 1.0 / (S[r] + I[r] + R[r]);
+                dS[r] = (-beta_ * S[r] * (I[r] * inv_N) + mu_ * R[r]);
+                dI[r] = I[r] * (beta_ * (S[r] * inv_N) - gamma_ - delta_ - alpha_);
+                dQ[r] = delta_ * I[r] - (gamma_ + alpha_) * Q[r];
+                dR[r] = gamma_ * (I[r] + Q[r]) - mu_ * R[r];
+                dD[r] = alpha_ * (I[r] + Q[r]);
+            }
+
+            // inflow from connected regions minus outflow
+            const auto &start = mobility_.row_start();
+            const auto &from = mobility_.columns();
+            const auto &rate = mobility_.values();
+            for (size_type c = 0; c < compartments; c++)
+            {
+                if (!mobile[c])
+                    continue;
+                const value_type *X = x + c * Regions;
+                value_type *dX = f + c * Regions;
+                for (size_type r = 0; r < Regions; r++)
+                {
+                    value_type flow = -outflow_[r] * X[r];
+                    for (size_type p = start[r]; p < start[r + 1]; p++)
+                        flow += rate[p] * X[from[p]];
+                    dX[r] += flow;
+                }
+            }
+        }
+
+        // local 5 x 5 pattern of every region, mobility couples mobile compartments of connected regions
+        void build_pattern()
+        {
+            static const constexpr bool local[compartments][compartments] = {{true, true, false, true, false},
+                                                                             {true, true, false, true, false},
+                                                                             {false, true, true, false, false},
+                                                                             {false, true, true, true, false},
+                                                                             {false, true, true, false, true}};
+            pattern_.assign(dim, {});
+            for (size_type c = 0; c < compartments; c++)
+            {
+                for (size_type r = 0; r < Regions; r++)
+                {
+                    auto &row = pattern_[c * Regions + r];
+                    for (size_type k = 0; k < compartments; k++)
+                    {
+                        if (local[c][k])
+                            row.push_back(k * Regions + r);
+                    }
+                    if (mobile[c])
+                    {
+                        for (size_type p = mobility_.row_start()[r]; p < mobility_.row_start()[r + 1]; p++)
+                            row.push_back(c * Regions + mobility_.columns()[p]);
+                    }
+                    std::sort(row.begin(), row.end());
+                }
+            }
+        }
+    };
+} // namespace siqrd
+#endif
@@ -1,33 +1,128 @@
 #ifndef RUNPARAMSEARCH_HPP
 #define RUNPARAMSEARCH_HPP
 /*
-    Wrapper functions to running CGM and BFGS methods.
+    Wrapper functions to running CGM, BFGS, L-BFGS-B and Levenberg-Marquardt methods, from a single starting guess or from many,
+    and bootstrap of a fit for confidence intervals of parameters.
 */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 namespace ublas = boost::numeric::ublas;
 
 #include "../saving/saveResults.hpp"
 #include "lse_siqrd.hpp"
+#include "lse_siqrd_batch.hpp"
+#include "odeSys_siqrd_batch.hpp"
+#include "../ode/heunBatch.hpp"
 #include "../optimization/cgm.hpp"
 #include "../optimization/bfgs.hpp"
+#include "../optimization/levenbergMarquardt.hpp"
+#include "../optimization/lbfgsb.hpp"
+#include "../optimization/logTransform.hpp"
+#include "../optimization/cachedTarget.hpp"
+#include "../optimization/multiStart.hpp"
+#include "../optimization/bootstrap.hpp"
+#include "../parallel/threadPool.hpp"
+#include "../profiling/counters.hpp"
 
 namespace siqrd
 {
+    // local search used by runMultiStart
+    enum class Optimizer
+    {
+        bfgs,
+        cgm,
+        lm,        // Levenberg-Marquardt on residuals of LSE
+        lbfgsb,    // L-BFGS-B within bounds (nonnegative parameters if no bounds are given)
+        lbfgsb_log // L-BFGS-B on logarithms of parameters
+    };
+
+    // L-BFGS-B within [lower, upper], log_space runs it on logarithms of parameters (zero lower bounds become -inf);
+    // in log space zero start values would stay at -inf (gradient there is zero), they start from min_log_start
+    template <typename target_type, typename vector_type>
+    vector_type boundedSearch(target_type &target, const vector_type &start, const vector_type &lower, const vector_type &upper,
+                              typename target_type::value_type tol, bool log_space, optimization::Report *report = nullptr)
+    {
+        typedef typename target_type::value_type value_type;
+        const value_type min_log_start = 1e-6;
+        if (!log_space)
+            return optimization::LBFGSB(target, start, lower, upper, tol, report);
+        vector_type log_start(start.size());
+        for (std::size_t i = 0; i < start.size(); i++)
+            log_start[i] = std::max(start[i], std::min(min_log_start, upper[i]));
+        optimization::LogTransform<target_type> log_target(target);
+        const vector_type optimum = optimization::from_log(optimization::LBFGSB(log_target, optimization::to_log(log_start),
+                                                                                optimization::to_log(lower), optimization::to_log(upper),
+                                                                                tol, report));
+#ifndef NINFO
+        // L-BFGS-B printed logarithms of the parameters
+        std::cout << "Final parameters (exp of log space variables):" << optimum << std::endl;
+#endif
+        return optimum;
+    }
+
+    // bounds keeping dim parameters nonnegative
+    template <typename vector_type>
+    void nonnegativeBounds(const std::size_t dim, vector_type &lower, vector_type &upper)
+    {
+        lower.resize(dim, false);
+        upper.resize(dim, false);
+        std::fill(lower.begin(), lower.end(), 0.0);
+        std::fill(upper.begin(), upper.end(), std::numeric_limits<typename vector_type::value_type>::infinity());
+    }
+
+    // local search with optimizer from start, returns parameters and target receives LSE at them,
+    // lower and upper bounds are used only by L-BFGS-B
+    template <typename nu_k_formula = optimization::FR_formula, typename target_type, typename vector_type>
+    vector_type localSearch(target_type &target_evaluator, const vector_type &start, typename target_type::value_type tol,
+                            Optimizer optimizer, const vector_type &lower, const vector_type &upper,
+                            typename target_type::value_type &target, optimization::Report *report = nullptr)
+    {
+        typedef typename target_type::value_type working_precision;
+        optimization::CachedTarget<target_type> cached_target(target_evaluator);
+        vector_type optimum(start.size());
+        if (optimizer == Optimizer::bfgs)
+        {
+            ublas::matrix<working_precision, ublas::column_major> identity_matrix = ublas::identity_matrix<working_precision>(target_type::dim);
+            optimum.assign(optimization::BFGS(cached_target, start, tol, identity_matrix, report));
+        }
+        else if (optimizer == Optimizer::cgm)
+            optimum.assign(optimization::CGM<nu_k_formula>(cached_target, start, tol, report));
+        else if (optimizer == Optimizer::lm)
+            optimum.assign(optimization::LevenbergMarquardt(target_evaluator, start, tol, report));
+        else
+            optimum.assign(boundedSearch(cached_target, start, lower, upper, tol, optimizer == Optimizer::lbfgsb_log, report));
+        target = cached_target(optimum);
+        return optimum;
+    }
+
     template <typename scheme, typename nu_k_formula = optimization::FR_formula>
-    void runCGM(std::string observations, std::string parameters, typename scheme::value_type tol)
+    void runCGM(std::string observations, std::string parameters, typename scheme::value_type tol,
+                GradientMethod gradient_method = GradientMethod::forward_difference, unsigned no_threads = 1)
     {
         const std::string in_folder = "inputs/",
                           out_folder = "outputs/",
                           out_file = out_folder + scheme::method_name + "_cgm_" + observations + ".out",
-                          observ_file = in_folder + observations + ".in",
+                          observ_file = observationFile(in_folder, observations),
                           param_file = in_folder + parameters + ".in";
 
         typedef typename scheme::value_type working_precision;
 
         siqrd::LSE_siqrd<scheme>
             target_evaluator(observ_file, param_file);
+        if (!target_evaluator.good() || !target_evaluator.set_gradient(gradient_method, no_threads))
+            std::exit(1);
         // get information about SIQRD eqns from LSE object
         auto eqns = target_evaluator.get_eqns(); //copy constructor? (should be correct, only float-type members)
         const int N = target_evaluator.get_N();
@@ -37,7 +132,13 @@ namespace siqrd
 
         // run the search, simulate again, write results
         eqns.set_parameters(starting_parameters);
-        auto final_params = optimization::CGM<nu_k_formula>(target_evaluator, starting_parameters, tol);
+        optimization::CachedTarget<decltype(target_evaluator)> cached_target(target_evaluator);
+        optimization::Report report;
+        profiling::Profile profile;
+        auto final_params = optimization::CGM<nu_k_formula>(cached_target, starting_parameters, tol, &report);
+#ifndef NINFO
+        profile.print(std::cout, std::string(scheme::method_name) + " CGM", report.iterations);
+#endif
         eqns.set_parameters(final_params);
         ode::OdeSolver<scheme> solver(N, T);
         solver.solve(eqns, scratchSpace);
@@ -46,12 +147,13 @@ namespace siqrd
     }
 
     template <typename scheme>
-    void runBFGS(std::string observations, std::string parameters, typename scheme::value_type tol)
+    void runBFGS(std::string observations, std::string parameters, typename scheme::value_type tol,
+                 GradientMethod gradient_method = GradientMethod::forward_difference, unsigned no_threads = 1)
     {
         const std::string in_folder = "inputs/",
                           out_folder = "outputs/",
                           out_file = out_folder + scheme::method_name + "_bfgs_" + observations + ".out",
-                          observ_file = in_folder + observations + ".in",
+                          observ_file = observationFile(in_folder, observations),
                           param_file = in_folder + parameters + ".in";
 
         typedef typename scheme::value_type working_precision;
@@ -59,6 +161,8 @@ namespace siqrd
 
         siqrd::LSE_siqrd<scheme>
             target_evaluator(observ_file, param_file);
+        if (!target_evaluator.good() || !target_evaluator.set_gradient(gradient_method, no_threads))
+            std::exit(1);
         // get information about SIQRD eqns from LSE object
         auto eqns = target_evaluator.get_eqns(); //copy constructor? (should be correct, only float-type members)
         const int N = target_evaluator.get_N();
@@ -68,7 +172,13 @@ namespace siqrd
 
         // run the search, simulate again, write results
         eqns.set_parameters(starting_parameters);
-        auto final_params = optimization::BFGS(target_evaluator, starting_parameters, tol);
+        optimization::CachedTarget<decltype(target_evaluator)> cached_target(target_evaluator);
+        optimization::Report report;
+        profiling::Profile profile;
+        auto final_params = optimization::BFGS(cached_target, starting_parameters, tol, identity_matrix, &report);
+#ifndef NINFO
+        profile.print(std::cout, std::string(scheme::method_name) + " BFGS", report.iterations);
+#endif
         eqns.set_parameters(final_params);
         ode::OdeSolver<scheme> solver(N, T);
         solver.solve(eqns, scratchSpace);
@@ -76,6 +186,324 @@ namespace siqrd
         saving::saveResults(T / N, scratchSpace, out_file);
     }
 
+    // L-BFGS-B keeping parameters nonnegative, optionally in log space
+    template <typename scheme>
+    void runLBFGSB(std::string observations, std::string parameters, typename scheme::value_type tol, bool log_space = false,
+                   GradientMethod gradient_method = GradientMethod::forward_difference, unsigned no_threads = 1)
+    {
+        const std::string in_folder = "inputs/",
+                          out_folder = "outputs/",
+                          out_file = out_folder + scheme::method_name + (log_space ? "_lbfgsb_log_" : "_lbfgsb_") + observations + ".out",
+                          observ_file = observationFile(in_folder, observations),
+                          param_file = in_folder + parameters + ".in";
+
+        typedef typename scheme::value_type working_precision;
+
+        siqrd::LSE_siqrd<scheme>
+            target_evaluator(observ_file, param_file);
+        if (!target_evaluator.good() || !target_evaluator.set_gradient(gradient_method, no_threads))
+            std::exit(1);
+        // get information about SIQRD eqns from LSE object
+        auto eqns = target_evaluator.get_eqns();
+        const int N = target_evaluator.get_N();
+        const working_precision T = target_evaluator.get_T();
+        const auto starting_parameters = eqns.parameters();
+        ublas::matrix<working_precision, ublas::column_major> scratchSpace(decltype(eqns)::dim, N + 1);
+        ublas::vector<working_precision> lower, upper;
+        nonnegativeBounds(decltype(target_evaluator)::dim, lower, upper);
+
+        // run the search, simulate again, write results
+        optimization::CachedTarget<decltype(target_evaluator)> cached_target(target_evaluator);
+        optimization::Report report;
+        profiling::Profile profile;
+        auto final_params = boundedSearch(cached_target, starting_parameters, lower, upper, tol, log_space, &report);
+#ifndef NINFO
+        profile.print(std::cout, std::string(scheme::method_name) + (log_space ? " L-BFGS-B (log)" : " L-BFGS-B"), report.iterations);
+#endif
+        eqns.set_parameters(final_params);
+        ode::OdeSolver<scheme> solver(N, T);
+        solver.solve(eqns, scratchSpace);
+        saving::saveResults(T / N, scratchSpace, out_file);
+    }
+
+    // Levenberg-Marquardt uses residuals and their jacobian from sensitivity equations, gradient_method is not used
+    template <typename scheme>
+    void runLM(std::string observations, std::string parameters, typename scheme::value_type tol)
+    {
+        const std::string in_folder = "inputs/",
+                          out_folder = "outputs/",
+                          out_file = out_folder + scheme::method_name + "_lm_" + observations + ".out",
+                          observ_file = observationFile(in_folder, observations),
+                          param_file = in_folder + parameters + ".in";
+
+        typedef typename scheme::value_type working_precision;
+
+        siqrd::LSE_siqrd<scheme>
+            target_evaluator(observ_file, param_file);
+        if (!target_evaluator.good() || !target_evaluator.sensitivity_available())
+            std::exit(1);
+        // get information about SIQRD eqns from LSE object
+        auto eqns = target_evaluator.get_eqns();
+        const int N = target_evaluator.get_N();
+        const working_precision T = target_evaluator.get_T();
+        const auto starting_parameters = eqns.parameters();
+        ublas::matrix<working_precision, ublas::column_major> scratchSpace(decltype(eqns)::dim, N + 1);
+
+        // run the search, simulate again, write results
+        optimization::Report report;
+        profiling::Profile profile;
+        auto final_params = optimization::LevenbergMarquardt(target_evaluator, starting_parameters, tol, &report);
+#ifndef NINFO
+        profile.print(std::cout, std::string(scheme::method_name) + " LM", report.iterations);
+#endif
+        eqns.set_parameters(final_params);
+        ode::OdeSolver<scheme> solver(N, T);
+        solver.solve(eqns, scratchSpace);
+        saving::saveResults(T / N, scratchSpace, out_file);
+    }
+
+    // fits parameters to observ_file starting from param_file without writing anything, used by batch runs
+    // params receive fitted parameters, lse LSE at them and report iterations and convergence of optimizer;
+    // returns false without fitting when the files cannot be read or LM cannot be used with scheme (message is printed)
+    template <typename scheme, typename nu_k_formula = optimization::FR_formula>
+    bool fitParameters(const std::string &observ_file, const std::string &param_file, typename scheme::value_type tol,
+                       Optimizer optimizer, ublas::vector<typename scheme::value_type> &params,
+                       typename scheme::value_type &lse, optimization::Report &report)
+    {
+        siqrd::LSE_siqrd<scheme> target_evaluator(observ_file, param_file);
+        if (!target_evaluator.good() || (optimizer == Optimizer::lm && !target_evaluator.sensitivity_available()))
+            return false;
+        const ublas::vector<typename scheme::value_type> starting_parameters = target_evaluator.get_eqns().parameters();
+        ublas::vector<typename scheme::value_type> lower, upper;
+        nonnegativeBounds(decltype(target_evaluator)::dim, lower, upper);
+        params = localSearch<nu_k_formula>(target_evaluator, starting_parameters, tol, optimizer, lower, upper, lse, &report);
+        return true;
+    }
+
+    // reads lower and upper bounds of parameters (two lines, file order beta mu gamma alpha delta)
+    // into vectors ordered as OdeSys_SIQRD::set_parameters
+    template <typename vector_type>
+    void readBounds(const std::string &bounds_file, vector_type &lower, vector_type &upper)
+    {
+        std::ifstream file(bounds_file);
+        vector_type *bounds[2] = {&lower, &upper};
+        for (auto b : bounds)
+        {
+            b->resize(5, false);
+            file >> (*b)[1] >> (*b)[4] >> (*b)[2] >> (*b)[0] >> (*b)[3];
+        }
+        assert(file.good());
+        file.close();
+    }
+
+    // LSE of every column of params with Heun's method, parameter sets are integrated together in lanes
+    // of LSE_siqrd_batch, batches of lanes run on pool and each worker thread owns its batch LSE
+    template <typename matrix_type, typename vector_type>
+    void batchLSE(parallel::ThreadPool &pool, const std::string &observ_file, const matrix_type &params, vector_type &lse)
+    {
+        typedef typename matrix_type::value_type working_precision;
+        typedef OdeSys_SIQRD_batch<working_precision> batch_eqns;
+        typedef LSE_siqrd_batch<ode::HeunBatch<batch_eqns>> batch_target;
+        assert(params.size2() == lse.size());
+
+        std::vector<std::unique_ptr<batch_target>> target_evaluators;
+        for (std::size_t i = 0; i < pool.size(); i++)
+        {
+            target_evaluators.push_back(std::make_unique<batch_target>(observ_file));
+        }
+        const std::size_t no_sets = params.size2(), lanes = batch_eqns::lanes;
+        auto task = [&](const std::size_t batch, const std::size_t worker) {
+            const std::size_t first = batch * lanes, last = std::min(first + lanes, no_sets);
+            ublas::vector<working_precision> batch_lse(last - first);
+            (*target_evaluators[worker])(ublas::subrange(params, 0, params.size1(), first, last), batch_lse);
+            ublas::subrange(lse, first, last).assign(batch_lse);
+        };
+        pool.run((no_sets + lanes - 1) / lanes, task);
+    }
+
+    // local searches from no_starts Latin hypercube points within bounds, each worker thread owns its LSE,
+    // writes optima sorted by LSE and simulation with the best parameters;
+    // candidates_per_start > 1 draws that many times more points and starts from those of lowest LSE (see batchLSE)
+    template <typename scheme, typename nu_k_formula = optimization::FR_formula>
+    optimization::MultiStartResult<typename scheme::value_type>
+    runMultiStart(std::string observations, std::string parameters, std::string bounds, const unsigned no_starts,
+                  typename scheme::value_type tol, Optimizer optimizer = Optimizer::bfgs,
+                  unsigned no_threads = std::thread::hardware_concurrency(), unsigned seed = 0,
+                  const unsigned candidates_per_start = 1)
+    {
+        const std::string in_folder = "inputs/",
+                          out_folder = "outputs/",
+                          out_file = out_folder + scheme::method_name + "_multistart_" + observations + ".out",
+                          optima_file = out_folder + scheme::method_name + "_multistart_" + observations + "_optima.out",
+                          observ_file = observationFile(in_folder, observations),
+                          param_file = in_folder + parameters + ".in",
+                          bounds_file = in_folder + bounds + ".in";
+
+        typedef typename scheme::value_type working_precision;
+        typedef siqrd::LSE_siqrd<scheme> target_type;
+        no_threads = std::max(1u, std::min(no_threads, no_starts));
+        if (optimizer == Optimizer::lm && !target_type::sensitivity_available())
+            std::exit(1);
+
+        ublas::vector<working_precision> lower, upper;
+        readBounds(bounds_file, lower, upper);
+        optimization::MultiStartResult<working_precision> result(target_type::dim, no_starts);
+        std::vector<std::unique_ptr<target_type>> target_evaluators;
+        for (unsigned i = 0; i < no_threads; i++)
+        {
+            target_evaluators.push_back(std::make_unique<target_type>(observ_file, param_file));
+            if (!target_evaluators.back()->good())
+                std::exit(1);
+        }
+        parallel::ThreadPool pool(no_threads);
+        std::mt19937_64 rng(seed);
+        if (candidates_per_start > 1)
+        {
+            ublas::matrix<working_precision, ublas::column_major> candidates(target_type::dim, no_starts * candidates_per_start);
+            ublas::vector<working_precision> candidate_lse(candidates.size2());
+            optimization::latin_hypercube(lower, upper, candidates, rng);
+            batchLSE(pool, observ_file, candidates, candidate_lse);
+            std::vector<std::size_t> order(candidates.size2());
+            for (std::size_t j = 0; j < order.size(); j++)
+                order[j] = j;
+            std::partial_sort(order.begin(), order.begin() + no_starts, order.end(), [&candidate_lse](const std::size_t a, const std::size_t b) {
+                return candidate_lse[a] < candidate_lse[b] || (std::isnan(candidate_lse[b]) && !std::isnan(candidate_lse[a]));
+            });
+            for (unsigned j = 0; j < no_starts; j++)
+                ublas::column(result.starts, j).assign(ublas::column(candidates, order[j]));
+        }
+        else
+        {
+            optimization::latin_hypercube(lower, upper, result.starts, rng);
+        }
+
+        // bounds file only limits where starts are drawn, local searches may leave the box (bounded ones stay nonnegative)
+        ublas::vector<working_precision> search_lower, search_upper;
+        nonnegativeBounds(target_type::dim, search_lower, search_upper);
+        auto optimize = [&target_evaluators, &search_lower, &search_upper, optimizer, tol](const auto &start, auto &optimum, const std::size_t worker) {
+            working_precision target;
+            optimum.assign(localSearch<nu_k_formula>(*target_evaluators[worker], start, tol, optimizer, search_lower, search_upper, target));
+            return target;
+        };
+        profiling::Profile profile;
+        optimization::multi_start(pool, result, optimize);
+#ifndef NINFO
+        profile.print(std::cout, std::string(scheme::method_name) + " multistart", 0);
+#endif
+
+        // optima sorted by LSE, parameters in file order beta mu gamma alpha delta
+        std::vector<std::size_t> order(no_starts);
+        for (unsigned j = 0; j < no_starts; j++)
+            order[j] = j;
+        std::sort(order.begin(), order.end(), [&result](const std::size_t a, const std::size_t b) {
+            return result.targets[a] < result.targets[b] || (std::isnan(result.targets[b]) && !std::isnan(result.targets[a]));
+        });
+        std::ofstream file(optima_file);
+        for (const auto j : order)
+        {
+            file << result.targets[j] << "  \t";
+            for (const auto i : {1, 4, 2, 0, 3})
+                file << result.optima(i, j) << "  \t";
+            for (const auto i : {1, 4, 2, 0, 3})
+                file << result.starts(i, j) << "  \t";
+            file << std::endl;
+        }
+        file.close();
+
+        // simulate with the best parameters, write results
+        auto eqns = target_evaluators[0]->get_eqns();
+        const int N = target_evaluators[0]->get_N();
+        const working_precision T = target_evaluators[0]->get_T();
+        ublas::matrix<working_precision, ublas::column_major> scratchSpace(decltype(eqns)::dim, N + 1);
+        eqns.set_parameters(ublas::column(result.optima, result.best));
+        ode::OdeSolver<scheme> solver(N, T);
+        solver.solve(eqns, scratchSpace);
+        saving::saveResults(T / N, scratchSpace, out_file);
+        return result;
+    }
+
+    // fit from parameters, then no_replicates refits of the fitted solution plus residuals resampled in blocks of
+    // block_length days, warm started from the fit; each worker thread owns its LSE and only replaces its observations,
+    // writes refitted parameters and returns percentile intervals at level confidence
+    template <typename scheme, typename nu_k_formula = optimization::FR_formula>
+    optimization::BootstrapResult<typename scheme::value_type>
+    runBootstrap(std::string observations, std::string parameters, const unsigned no_replicates,
+                 typename scheme::value_type tol, const unsigned block_length = 1, typename scheme::value_type confidence = 0.95,
+                 Optimizer optimizer = Optimizer::bfgs, unsigned no_threads = std::thread::hardware_concurrency(), unsigned seed = 0)
+    {
+        const std::string in_folder = "inputs/",
+                          out_folder = "outputs/",
+                          out_file = out_folder + scheme::method_name + "_bootstrap_" + observations + ".out",
+                          observ_file = observationFile(in_folder, observations),
+                          param_file = in_folder + parameters + ".in";
+
+        typedef typename scheme::value_type working_precision;
+        typedef siqrd::LSE_siqrd<scheme> target_type;
+        typedef ublas::matrix<working_precision, ublas::column_major> matrix_type;
+        no_threads = std::max(1u, std::min(no_threads, no_replicates));
+
+        std::vector<std::unique_ptr<target_type>> target_evaluators;
+        for (unsigned i = 0; i < no_threads; i++)
+        {
+            target_evaluators.push_back(std::make_unique<target_type>(observ_file, param_file));
+            if (!target_evaluators.back()->good())
+                std::exit(1);
+        }
+        // blocks are drawn from days 1 .. no_days - 1, day 0 is the kept initial condition
+        if (block_length == 0 || block_length >= target_evaluators[0]->no_days())
+        {
+            std::cerr << "Block length has to be between 1 and " << target_evaluators[0]->no_days() - 1 << " for "
+                      << observ_file << ", got " << block_length << std::endl;
+            std::exit(1);
+        }
+        ublas::vector<working_precision> lower, upper;
+        nonnegativeBounds(target_type::dim, lower, upper);
+        optimization::BootstrapResult<working_precision> result(target_type::dim, no_replicates);
+        result.confidence = confidence;
+
+        // fitted solution and its residuals at observed days, shared by all replicates
+        const ublas::vector<working_precision> starting_parameters = target_evaluators[0]->get_eqns().parameters();
+        working_precision lse;
+        result.estimate.assign(localSearch<nu_k_formula>(*target_evaluators[0], starting_parameters, tol, optimizer, lower, upper, lse));
+        const std::size_t no_days = target_evaluators[0]->no_days();
+        matrix_type fitted(OdeSys_SIQRD<>::dim, no_days), residuals(OdeSys_SIQRD<>::dim, no_days);
+        target_evaluators[0]->states_at_days(result.estimate, fitted);
+        noalias(residuals) = target_evaluators[0]->observations() - fitted;
+
+        std::vector<matrix_type> replicate_data(no_threads, fitted);
+        auto refit = [&](const std::size_t replicate, auto &estimate, bool &converged, const std::size_t worker) {
+            // generator seeded by replicate index, results do not depend on scheduling of replicates
+            std::seed_seq seeds{seed, (unsigned)replicate};
+            std::mt19937_64 rng(seeds);
+            optimization::resample_residuals(fitted, residuals, replicate_data[worker], (std::size_t)block_length, rng);
+            target_evaluators[worker]->set_observations(replicate_data[worker]);
+            optimization::Report report;
+            working_precision target;
+            estimate.assign(localSearch<nu_k_formula>(*target_evaluators[worker], result.estimate, tol, optimizer,
+                                                      lower, upper, target, &report));
+            converged = report.converged;
+            return target;
+        };
+        parallel::ThreadPool pool(no_threads);
+        profiling::Profile profile;
+        optimization::bootstrap(pool, result, refit);
+#ifndef NINFO
+        profile.print(std::cout, std::string(scheme::method_name) + " bootstrap", 0);
+#endif
+
+        // one line per replicate: LSE, convergence, parameters in file order beta mu gamma alpha delta
+        std::ofstream file(out_file);
+        for (unsigned j = 0; j < no_replicates; j++)
+        {
+            file << result.targets[j] << "  \t" << (int)result.converged[j] << "  \t";
+            for (const auto i : {1, 4, 2, 0, 3})
+                file << result.replicates(i, j) << "  \t";
+            file << std::endl;
+        }
+        file.close();
+        return result;
+    }
+
 } // namespace siqrd
 
 #endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+#ifndef SCENARIOSWEEP_HPP
+#define SCENARIOSWEEP_HPP
+/*
+    Sweep of SIQRD simulations over a grid of parameters. Summary metrics (peak of infected, its time,
+    final deaths and attack rate) are accumulated by an observer during each solve, trajectories are never stored,
+    so memory and output grow with the number of grid points only, not with number of time steps.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/numeric/ublas/vector.hpp>
+namespace ublas = boost::numeric::ublas;
+
+#include "odeSys_siqrd.hpp"
+#include "../ode/odeSolver.hpp"
+#include "../parallel/threadPool.hpp"
+#include "../saving/bufferedWriter.hpp"
+
+namespace siqrd
+{
+    template <typename Type>
+    struct ScenarioSummary
+    {
+        Type peak_infected, peak_time, final_dead, attack_rate;
+    };
+
+    /*
+////Satisfies concepts:
+observer_type of OdeSolver::solve
+    member functions:
+        void operator()(size_type step, const state_type &state)
+    */
+    // attack rate is the number of new infections over total population, new infections are
+    // S(0) - S(T) plus susceptibles returned from recovered (mu * integral of R, trapezoidal rule),
+    // reinfections count again, so it may exceed 1 when immunity is lost
+    template <typename value_type, typename size_type = std::size_t>
+    class SummaryObserver
+    {
+    private:
+        const value_type dt_, mu_;
+        value_type S0_, population_, last_S_, last_R_, returned_;
+        ScenarioSummary<value_type> &summary_;
+
+    public:
+        SummaryObserver(const value_type dt, const value_type mu, ScenarioSummary<value_type> &summary)
+            : dt_(dt), mu_(mu), summary_(summary){};
+
+    public:
+        template <typename vector_type>
+        void operator()(const size_type step, const vector_type &state)
+        {
+            if (step == 0)
+            {
+                S0_ = state[0];
+                population_ = state[0] + state[1] + state[2] + state[3] + state[4];
+                returned_ = 0.0;
+                summary_.peak_infected = state[1];
+                summary_.peak_time = 0.0;
+            }
+            else
+            {
+                returned_ += 0.5 * dt_ * mu_ * (last_R_ + state[3]);
+                if (state[1] > summary_.peak_infected)
+                {
+                    summary_.peak_infected = state[1];
+                    summary_.peak_time = step * dt_;
+                }
+            }
+            last_S_ = state[0];
+            last_R_ = state[3];
+            summary_.final_dead = state[4];
+            summary_.attack_rate = (S0_ - last_S_ + returned_) / population_;
+        }
+    };
+
+    // grid over parameters, every parameter has no_points equidistant values in [lower, upper] (only lower if 1 point),
+    // vectors are ordered as OdeSys_SIQRD::set_parameters, the last parameter in file order (delta) changes fastest
+    template <typename Type>
+    class ScenarioGrid
+    {
+    public:
+        typedef Type value_type;
+        typedef std::size_t size_type;
+
+    private:
+        ublas::vector<value_type> lower_, upper_;
+        std::vector<size_type> no_points_;
+
+    public:
+        const static size_type constexpr dim = OdeSys_SIQRD<>::no_params;
+        // parameter indices in file order beta mu gamma alpha delta
+        const static constexpr size_type file_order[dim] = {1, 4, 2, 0, 3};
+
+    public:
+        // one line per parameter in file order beta mu gamma alpha delta: lower upper number_of_points,
+        // a file that cannot be read leaves the grid empty after printing what is wrong, callers check good()
+        ScenarioGrid(const std::string &grid_file) : lower_(dim), upper_(dim), no_points_(dim, 0)
+        {
+            std::ifstream file(grid_file);
+            if (!file)
+            {
+                std::cerr << "Cannot open grid file " << grid_file << std::endl;
+                return;
+            }
+            for (size_type k = 0; k < dim; k++)
+            {
+                const size_type i = file_order[k];
+                long long no_points;
+                file >> lower_[i] >> upper_[i] >> no_points;
+                if (!file || !std::isfinite(lower_[i]) || !std::isfinite(upper_[i]) || lower_[i] > upper_[i] || no_points < 1)
+                {
+                    std::cerr << "Grid file " << grid_file << " line " << k + 1
+                              << " is not lower upper number_of_points with lower <= upper and at least 1 point" << std::endl;
+                    std::fill(no_points_.begin(), no_points_.end(), 0);
+                    return;
+                }
+                no_points_[i] = no_points;
+            }
+        };
+
+    public:
+        bool good() const { return std::all_of(no_points_.begin(), no_points_.end(), [](const size_type n) { return n > 0; }); }
+
+        size_type size() const
+        {
+            size_type ret = 1;
+            for (const auto n : no_points_)
+                ret *= n;
+            return ret;
+        }
+
+        template <typename vector_type>
+        void point(size_type index, vector_type &params) const
+        {
+            assert(index < size());
+            for (size_type k = dim; k-- > 0;)
+            {
+                const size_type i = file_order[k], j = index % no_points_[i];
+                index /= no_points_[i];
+                params[i] = no_points_[i] == 1 ? lower_[i] : lower_[i] + j * (upper_[i] - lower_[i]) / (no_points_[i] - 1);
+            }
+        }
+    };
+
+    // simulates every point of grid_file with initial condition of param_file on no_threads threads,
+    // each thread owns its copy of equations and solver, writes one line of parameters and summary per point;
+    // returns the number of points, 0 if the grid file cannot be read
+    template <typename scheme>
+    typename ScenarioGrid<typename scheme::value_type>::size_type
+    runSweep(const std::string &grid_file, const std::string &param_file, const int N, const typename scheme::value_type T,
+             const std::string &out_file, unsigned no_threads = std::thread::hardware_concurrency())
+    {
+        typedef typename scheme::value_type working_precision;
+        typedef OdeSys_SIQRD<working_precision> eqns_type;
+        typedef typename ScenarioGrid<working_precision>::size_type size_type;
+        const size_type chunk = 64; // points per task, amortizes scheduling of short solves
+
+        const ScenarioGrid<working_precision> grid(grid_file);
+        if (!grid.good())
+            return 0;
+        const size_type no_points = grid.size();
+        no_threads = std::max(1u, std::min(no_threads, (unsigned)((no_points + chunk - 1) / chunk)));
+
+        const eqns_type eqns(param_file);
+        std::vector<eqns_type> worker_eqns(no_threads, eqns);
+        std::vector<ode::OdeSolver<scheme>> solvers(no_threads, ode::OdeSolver<scheme>(N, T));
+        std::vector<ScenarioSummary<working_precision>> summaries(no_points);
+
+        auto task = [&](const size_type task, const size_type worker) {
+            ublas::vector<working_precision> params(eqns_type::no_params);
+            for (size_type p = task * chunk; p < std::min(no_points, (task + 1) * chunk); p++)
+            {
+                grid.point(p, params);
+                worker_eqns[worker].set_parameters(params);
+                SummaryObserver<working_precision> observer(T / N, params[4], summaries[p]);
+                solvers[worker].solve(worker_eqns[worker], observer);
+            }
+        };
+        parallel::ThreadPool pool(no_threads);
+        pool.run((no_points + chunk - 1) / chunk, task);
+
+        // parameters in file order, then summary
+        saving::BufferedWriter writer(out_file);
+        writer.write("# beta\tmu\tgamma\talpha\tdelta\tpeak_I\tt_peak\tfinal_D\tattack_rate\n");
+        ublas::vector<working_precision> params(eqns_type::no_params);
+        for (size_type p = 0; p < no_points; p++)
+        {
+            grid.point(p, params);
+            for (const auto i : grid.file_order)
+            {
+                writer.write(params[i]);
+                writer.write("\t");
+            }
+            const auto &s = summaries[p];
+            for (const working_precision value : {s.peak_infected, s.peak_time, s.final_dead})
+            {
+                writer.write(value);
+                writer.write("\t");
+            }
+            writer.write(s.attack_rate);
+            writer.write("\n");
+        }
+        return no_points;
+    }
+} // namespace siqrd
+#endif
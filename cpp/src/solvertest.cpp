@@ -1,18 +1,24 @@
 /*
     Name:     solvertest
-    Purpose:  Test ODE solvers on special system of ODEs.
+    Purpose:  Test ODE solvers on special system of ODEs. Optimized build also checks that solves, LSE evaluations and gradients do not allocate.
     Author:   pavel.macak@fs.cvut.cz
     Compilation: Makefile is provided - make run2 to run after compilation, make solvertest to only compile.
     Command line arguments: (2) Number of time steps and final simulation time.
-    Input files: None
-    Output files: None
+    Input files: 'observations1.in', 'parameters_observations1.in', 'parameters.in'
+    Output files: 'outputs/solvertest.bin' (binary results round trip)
 */
 #include "debug_levels.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <new>
 #include <iomanip>
+#include <random>
 #include <string>
+#include <vector>
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/vector.hpp>
@@ -22,11 +28,452 @@
 namespace ublas = boost::numeric::ublas;
 
 #include "ode/odeSys_test.hpp"
+#include "ode/odeSys_test_banded.hpp"
+#include "ode/odeSys_test_linear.hpp"
 #include "ode/odeSolver.hpp"
 #include "ode/eulerForward.hpp"
 #include "ode/heun.hpp"
+#include "ode/explicitRK.hpp"
+#include "ode/adaptiveRK.hpp"
 #include "ode/eulerBackward.hpp"
+#include "ode/bdf2.hpp"
+#include "ode/trbdf2.hpp"
+#include "ode/rosenbrock.hpp"
+#include "ode/heunBatch.hpp"
+#include "ode/eulerForwardBatch.hpp"
+#include "siqrd/lse_siqrd.hpp"
+#include "siqrd/lse_siqrd_batch.hpp"
+#include "siqrd/odeSys_siqrd_batch.hpp"
+#include "siqrd/odeSys_siqrd_meta.hpp"
+#include "ode/csrMatrix.hpp"
+#include "ode/sparseLU.hpp"
 #include "saving/saveResults.hpp"
+#include "saving/binaryResults.hpp"
+
+// counts heap allocations, time stepping is expected to make none
+static std::size_t no_allocations = 0;
+void *operator new(std::size_t size)
+{
+    no_allocations++;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+// LSE of every lane of BatchScheme has to match LSE of Scheme, parameter sets are scaled fitted parameters
+template <typename BatchScheme, typename Scheme>
+bool lanesMatchScalar()
+{
+    typedef typename Scheme::value_type value_type;
+    siqrd::LSE_siqrd<Scheme> lse("inputs/observations1.in", "inputs/parameters_observations1.in");
+    siqrd::LSE_siqrd_batch<BatchScheme> lse_batch("inputs/observations1.in");
+    const auto fitted_params = lse.get_eqns().parameters();
+    ublas::matrix<value_type, ublas::column_major> batch_params(fitted_params.size(), BatchScheme::lanes + 3);
+    ublas::vector<value_type> batch_lse(batch_params.size2());
+    for (std::size_t j = 0; j < batch_params.size2(); j++)
+    {
+        ublas::column(batch_params, j).assign((1.0 + 0.05 * j) * fitted_params);
+    }
+    lse_batch(batch_params, batch_lse);
+    value_type difference = 0.0;
+    for (std::size_t j = 0; j < batch_params.size2(); j++)
+    {
+        const value_type scalar_lse = lse(ublas::column(batch_params, j));
+        difference = std::max(difference, std::fabs(batch_lse[j] - scalar_lse) / scalar_lse);
+    }
+#ifndef NINFO
+    std::cout << Scheme::method_name << " batch: Largest relative difference of lane LSE to scalar LSE: " << difference << std::endl
+              << std::endl;
+#endif
+    if (!(difference < 1e-12))
+    {
+        std::cerr << "Batched and scalar " << Scheme::method_name << " LSE differ by " << difference << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// heap allocations of LSE evaluations and gradients with Scheme, the hot path of parameter fitting
+template <typename Scheme>
+std::size_t lseAllocations()
+{
+    typedef typename Scheme::value_type value_type;
+    siqrd::LSE_siqrd<Scheme> lse("inputs/observations1.in", "inputs/parameters_observations1.in");
+    const ublas::vector<value_type> params(lse.get_eqns().parameters());
+    ublas::vector<value_type> grad(params.size());
+    value_type value;
+
+    std::size_t allocations = no_allocations;
+    const value_type lse_0 = lse(params);
+    lse.bounded(params, 2.0 * lse_0, value);
+    lse.gradient(params, lse_0, grad);
+    lse.lse_gradient(params, grad);
+    allocations = no_allocations - allocations;
+
+    lse.set_gradient(siqrd::GradientMethod::adjoint);
+    allocations -= no_allocations;
+    lse.gradient(params, lse_0, grad);
+    allocations += no_allocations;
+    return allocations;
+}
+
+// finite difference gradients of LSE computed on a thread pool (one task per perturbed solve, workspace per worker)
+// have to be equal to the serial ones, forward and central
+template <typename Scheme>
+bool pooledGradientMatchesSerial()
+{
+    typedef typename Scheme::value_type value_type;
+    siqrd::LSE_siqrd<Scheme> lse("inputs/observations1.in", "inputs/parameters_observations1.in");
+    const ublas::vector<value_type> params(lse.get_eqns().parameters());
+    const value_type lse_0 = lse(params);
+    ublas::vector<value_type> serial_grad(params.size()), pooled_grad(params.size());
+    for (const auto method : {siqrd::GradientMethod::forward_difference, siqrd::GradientMethod::central_difference})
+    {
+        lse.set_gradient(method);
+        lse.gradient(params, lse_0, serial_grad);
+        lse.set_gradient(method, 3);
+        lse.gradient(params, lse_0, pooled_grad);
+        const double difference = ublas::norm_inf(pooled_grad - serial_grad);
+        if (difference != 0.0)
+        {
+            std::cerr << (method == siqrd::GradientMethod::central_difference ? "Central" : "Forward")
+                      << " difference gradient on a pool differs from serial one by " << difference << "!" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// adjoint gradient of LSE with Scheme has to match the gradient from sensitivity equations, both are exact gradients
+// of the discrete solution up to newton tolerance of implicit schemes
+template <typename Scheme>
+bool adjointMatchesSensitivity()
+{
+    typedef typename Scheme::value_type value_type;
+    siqrd::LSE_siqrd<Scheme> lse("inputs/observations1.in", "inputs/parameters_observations1.in");
+    const ublas::vector<value_type> params(lse.get_eqns().parameters());
+    ublas::vector<value_type> sensitivity_grad(params.size()), adjoint_grad(params.size());
+    lse.set_gradient(siqrd::GradientMethod::sensitivity);
+    lse.lse_gradient(params, sensitivity_grad);
+    lse.set_gradient(siqrd::GradientMethod::adjoint);
+    lse.lse_gradient(params, adjoint_grad);
+    const double difference = ublas::norm_inf(adjoint_grad - sensitivity_grad) / ublas::norm_inf(sensitivity_grad);
+#ifndef NINFO
+    std::cout << Scheme::method_name << ": Relative difference of adjoint and sensitivity gradient: " << difference << std::endl
+              << std::endl;
+#endif
+    if (!(difference < 1e-8))
+    {
+        std::cerr << "Adjoint and sensitivity gradient of " << Scheme::method_name << " differ by " << difference << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// LSE gradient of Scheme from sensitivity equations has to match central finite differences (their error is about 1e-7)
+template <typename Scheme>
+bool sensitivityMatchesDifferences()
+{
+    typedef typename Scheme::value_type value_type;
+    siqrd::LSE_siqrd<Scheme> lse("inputs/observations1.in", "inputs/parameters_observations1.in");
+    const ublas::vector<value_type> params(lse.get_eqns().parameters());
+    ublas::vector<value_type> sensitivity_grad(params.size()), difference_grad(params.size());
+    lse.set_gradient(siqrd::GradientMethod::sensitivity);
+    lse.lse_gradient(params, sensitivity_grad);
+    lse.set_gradient(siqrd::GradientMethod::central_difference);
+    lse.gradient(params, lse(params), difference_grad);
+    const double difference = ublas::norm_inf(sensitivity_grad - difference_grad) / ublas::norm_inf(difference_grad);
+    if (!(difference < 1e-6))
+    {
+        std::cerr << "Sensitivity and finite difference gradient of " << Scheme::method_name << " differ by " << difference << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// observed order of Scheme on linear OdeSys_test_linear, log2 of ratio of errors at T with N and 2N steps,
+// has to be within 0.1 of Scheme::order (on the nonlinear OdeSys_test explicit schemes reach round-off
+// before the ratio settles)
+template <typename Scheme>
+bool hasOrder(const int N, const double T)
+{
+    typedef typename Scheme::value_type value_type;
+    auto eqns = ode::OdeSys_test_linear<value_type>();
+    const auto analytic = eqns.analytic_solution(T);
+    double error[2];
+    for (int refinement = 0; refinement < 2; refinement++)
+    {
+        const int steps = N << refinement;
+        ublas::matrix<value_type, ublas::column_major> space(Scheme::dim, steps + 1);
+        ode::OdeSolver<Scheme> solver(steps, T);
+        solver.solve(eqns, space);
+        error[refinement] = ublas::norm_2(ublas::column(space, steps) - analytic) / ublas::norm_2(analytic);
+    }
+    const double order = std::log2(error[0] / error[1]);
+#ifndef NINFO
+    std::cout << Scheme::method_name << ": Relative error at time " << T << " with " << N << " and " << 2 * N << " steps: "
+              << error[0] << ", " << error[1] << ", observed order " << order << std::endl
+              << std::endl;
+#endif
+    if (!(std::fabs(order - Scheme::order) < 0.1))
+    {
+        std::cerr << Scheme::method_name << " has observed order " << order << " instead of " << Scheme::order << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// adaptive Scheme on OdeSys_test: states at output times of OdeSolver (time_step) and at irregular times, several of them
+// inside one internal step (dense output of solve_at), have to follow analytic solution and tighten with tolerances
+template <typename Scheme>
+bool adaptiveChecks(const int N, const double T)
+{
+    typedef typename Scheme::value_type value_type;
+    auto eqns = ode::OdeSys_test<value_type>();
+    double output_error = 0.0;
+    ublas::matrix<value_type, ublas::column_major> space(Scheme::dim, N + 1);
+    ode::OdeSolver<Scheme> solver(N, T);
+    solver.solve(eqns, space);
+    for (int i = 0; i <= N; i++)
+    {
+        const auto analytic = eqns.analytic_solution(T * i / N);
+        output_error = std::max(output_error, (double)(ublas::norm_2(ublas::column(space, i) - analytic) / ublas::norm_2(analytic)));
+    }
+
+    const std::vector<value_type> times = {0.0, 1e-4 * T, 0.1 * T, 0.1001 * T, 0.1002 * T, 0.37 * T, 0.73 * T, 0.9999 * T, T};
+    const value_type tolerances[2] = {1e-5, 1e-9};
+    double dense_error[2] = {0.0, 0.0};
+    bool solved = true;
+    for (int i = 0; i < 2; i++)
+    {
+        Scheme method(N, T);
+        method.set_tolerances(tolerances[i], tolerances[i]);
+        auto observer = [&](const std::size_t index, const auto &state) {
+            const auto analytic = eqns.analytic_solution(times[index]);
+            dense_error[i] = std::max(dense_error[i], (double)(ublas::norm_2(state - analytic) / ublas::norm_2(analytic)));
+        };
+        solved = method.solve_at(eqns, times, observer) && solved;
+    }
+#ifndef NINFO
+    std::cout << Scheme::method_name << ": Largest relative error at " << N << " output times until " << T << ": " << output_error
+              << ", at irregular times with tolerances " << tolerances[0] << " and " << tolerances[1] << ": " << dense_error[0]
+              << ", " << dense_error[1] << std::endl
+              << std::endl;
+#endif
+    if (!solved || !(output_error < 1e-6) || !(dense_error[0] < 1e-3) || !(dense_error[1] < 1e-7) ||
+        !(dense_error[1] < dense_error[0]))
+    {
+        std::cerr << Scheme::method_name << " does not follow analytic solution within tolerance!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// largest relative residual of dense A x = b (or A^T x = b)
+template <typename matrix_type, typename vector_type>
+double relativeResidual(const matrix_type &A, const vector_type &x, const vector_type &b, const bool transposed = false)
+{
+    vector_type Ax(b.size());
+    if (transposed)
+        Ax.assign(ublas::prod(ublas::trans(A), x));
+    else
+        Ax.assign(ublas::prod(A, x));
+    return ublas::norm_inf(Ax - b) / ublas::norm_inf(b);
+}
+
+// CsrMatrix product and SparseLU solves checked against dense matrices; reverse Cuthill-McKee has to recover
+// a shuffled tridiagonal matrix, so factors without pivoting have no fill; moving an entry (same nnz)
+// has to make the next factorization analyze the new pattern
+bool sparseChecks()
+{
+    typedef double value_type;
+    typedef std::size_t size_type;
+    const size_type n = 40;
+    std::vector<size_type> shuffle(n);
+    for (size_type i = 0; i < n; i++)
+        shuffle[i] = i;
+    std::mt19937 rng(1);
+    std::shuffle(shuffle.begin(), shuffle.end(), rng);
+
+    // (i, j, value) of tridiagonal 4, -1 matrix in shuffled order, optionally with entry (0, 1) moved to (0, 5)
+    auto build = [&](const bool moved, ode::CsrMatrix<value_type, size_type> &csr, ublas::matrix<value_type> &dense) {
+        std::vector<std::vector<size_type>> rows(n);
+        dense = ublas::zero_matrix<value_type>(n, n);
+        for (size_type i = 0; i < n; i++)
+        {
+            for (size_type j = (i > 0 ? i - 1 : 0); j < std::min(i + 2, n); j++)
+            {
+                const size_type column = moved && i == 0 && j == 1 ? 5 : j;
+                rows[shuffle[i]].push_back(shuffle[column]);
+                dense(shuffle[i], shuffle[column]) = i == j ? 4.0 : -1.0;
+            }
+        }
+        for (auto &row : rows)
+            std::sort(row.begin(), row.end());
+        csr.set_pattern(n, rows);
+        for (size_type i = 0; i < n; i++)
+            for (const size_type j : rows[i])
+                csr(i, j) = dense(i, j);
+    };
+
+    ode::CsrMatrix<value_type, size_type> csr;
+    ublas::matrix<value_type> dense;
+    ode::SparseLU<value_type, size_type> lu;
+    ublas::vector<value_type> b(n), x(n), y(n);
+    for (size_type i = 0; i < n; i++)
+        b[i] = 1.0 + i % 7;
+
+    build(false, csr, dense);
+    csr.prod(b, y);
+    const double prod_error = ublas::norm_inf(y - ublas::prod(dense, b)) / ublas::norm_inf(y);
+    lu.factorize(csr);
+    const size_type factor_nnz = lu.nnz();
+    x.assign(b);
+    lu.solve(x);
+    double residual = relativeResidual(dense, x, b);
+    x.assign(b);
+    lu.solve_transposed(x);
+    residual = std::max(residual, relativeResidual(dense, x, b, true));
+
+    build(true, csr, dense);
+    lu.factorize(csr);
+    x.assign(b);
+    lu.solve(x);
+    residual = std::max(residual, relativeResidual(dense, x, b));
+#ifndef NINFO
+    std::cout << "sparse: CsrMatrix product error " << prod_error << ", nonzeros of factors " << factor_nnz
+              << " (tridiagonal " << 3 * n - 2 << "), largest relative residual " << residual << std::endl
+              << std::endl;
+#endif
+    if (!(prod_error < 1e-14) || factor_nnz != 3 * n - 2 || !(residual < 1e-12))
+    {
+        std::cerr << "Sparse matrix checks failed: product error " << prod_error << ", " << factor_nnz
+                  << " nonzeros of factors, residual " << residual << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// metapopulation: CsrMatrix jacobian against central differences of right hand side, mobility has to conserve
+// population, and without mobility the seeded region has to follow the single population system
+bool metaChecks()
+{
+    typedef double value_type;
+    typedef siqrd::OdeSys_SIQRD_meta<4, value_type> meta_system;
+    typedef typename meta_system::size_type size_type;
+    const size_type dim = meta_system::dim;
+    const int N = 1000;
+    const value_type T = 100.0;
+
+    meta_system eqns("inputs/parameters.in", siqrd::ringMobility(meta_system::regions, 0.05), 1);
+    ublas::vector<value_type> x(eqns.initial_condition()), f_plus(dim), f_minus(dim), column(dim);
+    for (size_type k = 0; k < dim; k++)
+        x[k] += 1.0 + k % 3;
+    ode::CsrMatrix<value_type, size_type> jac;
+    eqns.jacobian(x, jac);
+    double jacobian_error = 0.0, jacobian_scale = 0.0;
+    for (size_type j = 0; j < dim; j++)
+    {
+        const value_type h = 1e-6 * std::max(1.0, std::fabs(x[j]));
+        x[j] += h;
+        eqns(x, f_plus);
+        x[j] -= 2 * h;
+        eqns(x, f_minus);
+        x[j] += h;
+        column.assign((f_plus - f_minus) / (2 * h));
+        for (size_type i = 0; i < dim; i++)
+        {
+            const size_type p = std::lower_bound(jac.columns().begin() + jac.row_start()[i],
+                                                 jac.columns().begin() + jac.row_start()[i + 1], j) - jac.columns().begin();
+            const bool in_pattern = p < jac.row_start()[i + 1] && jac.columns()[p] == j;
+            const value_type analytic = in_pattern ? jac.values()[p] : 0.0;
+            jacobian_error = std::max(jacobian_error, (double)std::fabs(analytic - column[i]));
+            jacobian_scale = std::max(jacobian_scale, (double)std::fabs(analytic));
+        }
+    }
+    jacobian_error /= jacobian_scale;
+
+    typedef ode::EulerBackward<meta_system> meta_bwe;
+    ublas::matrix<value_type, ublas::column_major> meta_space(dim, N + 1);
+    ode::OdeSolver<meta_bwe> meta_solver(N, T);
+    meta_solver.solve(eqns, meta_space);
+    const value_type population = ublas::sum(ublas::column(meta_space, 0));
+    const double conservation_error = std::fabs(ublas::sum(ublas::column(meta_space, N)) - population) / population;
+
+    // mobility with links outside of the ring pattern, the used solver has to give the same solution as a new one
+    eqns.set_mobility({{0, 2, 0.05}, {3, 1, 0.05}, {1, 0, 0.02}});
+    ublas::matrix<value_type, ublas::column_major> fresh_space(dim, N + 1);
+    ode::OdeSolver<meta_bwe> fresh_solver(N, T);
+    meta_solver.solve(eqns, meta_space);
+    fresh_solver.solve(eqns, fresh_space);
+    const double pattern_difference = ublas::norm_inf(ublas::column(meta_space, N) - ublas::column(fresh_space, N));
+
+    meta_system uncoupled("inputs/parameters.in", {}, 0);
+    siqrd::OdeSys_SIQRD<value_type> single("inputs/parameters.in");
+    ublas::matrix<value_type, ublas::column_major> single_space(siqrd::OdeSys_SIQRD<value_type>::dim, N + 1);
+    ode::OdeSolver<ode::EulerBackward<siqrd::OdeSys_SIQRD<value_type>>> single_solver(N, T);
+    meta_solver.solve(uncoupled, meta_space);
+    single_solver.solve(single, single_space);
+    double region_difference = 0.0;
+    for (size_type c = 0; c < meta_system::compartments; c++)
+        region_difference = std::max(region_difference, (double)std::fabs(meta_space(c * meta_system::regions, N) - single_space(c, N)));
+    region_difference /= ublas::norm_inf(ublas::column(single_space, N));
+#ifndef NINFO
+    std::cout << "metapopulation: relative jacobian error " << jacobian_error << ", population change " << conservation_error
+              << ", uncoupled region difference to single population " << region_difference
+              << ", difference after changed mobility pattern " << pattern_difference << std::endl
+              << std::endl;
+#endif
+    if (!(jacobian_error < 1e-6) || !(conservation_error < 1e-10) || !(region_difference < 1e-8) || pattern_difference != 0.0)
+    {
+        std::cerr << "Metapopulation checks failed: jacobian error " << jacobian_error << ", population change "
+                  << conservation_error << ", region difference " << region_difference << ", pattern change difference "
+                  << pattern_difference << "!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// results written by saveResultsBinary and read back by loadResultsBinary, raw ones have to be exact,
+// quantized ones within quantum / 2, stored columns are every decimation-th and the last one
+template <typename matrix_type>
+bool resultsRoundTrip(const double dT, const matrix_type &results)
+{
+    const std::string file_name = "outputs/solvertest.bin";
+    const std::size_t decimations[] = {1, 7};
+    const double quanta[] = {0.0, 1e-9};
+    for (const std::size_t decimation : decimations)
+    {
+        for (const double quantum : quanta)
+        {
+            saving::saveResultsBinary(dT, results, file_name, decimation, quantum);
+            ublas::matrix<typename matrix_type::value_type> loaded;
+            ublas::vector<double> times;
+            saving::loadResultsBinary(file_name, loaded, times);
+            const std::size_t last = results.size2() - 1;
+            bool matches = loaded.size1() == results.size1() && times.size() == loaded.size2() &&
+                           loaded.size2() == saving::stored_columns(results.size2(), decimation) &&
+                           times[times.size() - 1] == last * dT;
+            double error = 0.0;
+            for (std::size_t k = 0; matches && k < loaded.size2(); k++)
+            {
+                const std::size_t column = std::min(k * decimation, last);
+                matches = times[k] == column * dT;
+                for (std::size_t i = 0; i < loaded.size1(); i++)
+                    error = std::max(error, (double)std::fabs(loaded(i, k) - results(i, column)));
+            }
+            if (!matches || !(error <= 0.5 * quantum * (1 + 1e-6)))
+            {
+                std::cerr << "Binary results with decimation " << decimation << " and quantum " << quantum
+                          << " do not match written ones (error " << error << ")!" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
 int main(int argc, char const *argv[])
 {
@@ -57,33 +504,179 @@ int main(int argc, char const *argv[])
     typedef typename ode::EulerForward<decltype(eqns)> fwe;
     typedef typename ode::EulerBackward<decltype(eqns)> bwe;
     typedef typename ode::Heun<decltype(eqns)> heun;
+    typedef typename ode::BDF2<decltype(eqns)> bdf2;
+    typedef typename ode::TrBdf2<decltype(eqns)> trbdf2;
+    typedef typename ode::Ros2<decltype(eqns)> ros2;
+    typedef typename ode::Rodas3<decltype(eqns)> rodas3;
 
     ublas::matrix<working_precision, ublas::column_major> scratch_space(decltype(eqns)::dim, N + 1);
     ode::OdeSolver<fwe> fwe_solver(N, T);
     ode::OdeSolver<bwe> bwe_solver(N, T);
     ode::OdeSolver<heun> heun_solver(N, T);
+    ode::OdeSolver<bdf2> bdf2_solver(N, T);
+    ode::OdeSolver<trbdf2> trbdf2_solver(N, T);
+    ode::OdeSolver<ros2> ros2_solver(N, T);
+    ode::OdeSolver<rodas3> rodas3_solver(N, T);
 
+    std::size_t solve_allocations = no_allocations;
     fwe_solver.solve(eqns, scratch_space);
+    solve_allocations = no_allocations - solve_allocations;
 #ifndef NINFO
     std::cout << "fwe: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - analytic) / ublas::norm_2(analytic) << std::endl
               << std::endl;
 #endif
     // saving::saveResults(T / N, scratch_space, "outputs/fwe_test.out");
 
+    solve_allocations -= no_allocations;
     bwe_solver.solve(eqns, scratch_space);
+    solve_allocations += no_allocations;
 #ifndef NINFO
     std::cout << "bwe: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - analytic) / ublas::norm_2(analytic) << std::endl
               << std::endl;
 #endif
     // saving::saveResults(T / N, scratch_space, "outputs/bwe_test.out");
 
+    solve_allocations -= no_allocations;
     heun_solver.solve(eqns, scratch_space);
+    solve_allocations += no_allocations;
 #ifndef NINFO
     std::cout << "heun: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - analytic) / ublas::norm_2(analytic) << std::endl
               << std::endl;
 #endif
     // saving::saveResults(T / N, scratch_space, "outputs/heun_test.out");
 
+    solve_allocations -= no_allocations;
+    bdf2_solver.solve(eqns, scratch_space);
+    solve_allocations += no_allocations;
+#ifndef NINFO
+    std::cout << "bdf2: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - analytic) / ublas::norm_2(analytic) << std::endl
+              << std::endl;
+#endif
+
+    solve_allocations -= no_allocations;
+    trbdf2_solver.solve(eqns, scratch_space);
+    solve_allocations += no_allocations;
+#ifndef NINFO
+    std::cout << "trbdf2: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - analytic) / ublas::norm_2(analytic) << std::endl
+              << std::endl;
+#endif
+
+    solve_allocations -= no_allocations;
+    ros2_solver.solve(eqns, scratch_space);
+    solve_allocations += no_allocations;
+#ifndef NINFO
+    std::cout << "ros2: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - analytic) / ublas::norm_2(analytic) << std::endl
+              << std::endl;
+#endif
+
+    solve_allocations -= no_allocations;
+    rodas3_solver.solve(eqns, scratch_space);
+    solve_allocations += no_allocations;
+#ifndef NINFO
+    std::cout << "rodas3: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - analytic) / ublas::norm_2(analytic) << std::endl
+              << std::endl;
+#endif
+    if (!resultsRoundTrip(T / N, scratch_space))
+    {
+        return 1;
+    }
+
+    // banded jacobian (BandedMatrix, BandedLU) has to give the same steps as dense factorization of the same system
+    auto banded_eqns = ode::OdeSys_test_banded<working_precision>();
+    auto banded_analytic = banded_eqns.analytic_solution(T);
+    typedef typename ode::EulerBackward<decltype(banded_eqns)> bwe_banded;
+    typedef typename ode::EulerBackward<decltype(banded_eqns), ode::full_newton, ode::dense_jacobian> bwe_dense;
+
+    ublas::matrix<working_precision, ublas::column_major> dense_space(decltype(banded_eqns)::dim, N + 1);
+    ode::OdeSolver<bwe_banded> bwe_banded_solver(N, T);
+    ode::OdeSolver<bwe_dense> bwe_dense_solver(N, T);
+
+    solve_allocations -= no_allocations;
+    bwe_banded_solver.solve(banded_eqns, scratch_space);
+    solve_allocations += no_allocations;
+    bwe_dense_solver.solve(banded_eqns, dense_space);
+    const working_precision banded_difference = ublas::norm_2(ublas::column(scratch_space, N) - ublas::column(dense_space, N)) /
+                                                ublas::norm_2(ublas::column(dense_space, N));
+#ifndef NINFO
+    std::cout << "bwe banded: Relative error at time " << T << ": " << ublas::norm_2(ublas::column(scratch_space, N) - banded_analytic) / ublas::norm_2(banded_analytic) << std::endl
+              << "            Relative difference to dense jacobian: " << banded_difference << std::endl
+              << std::endl;
+#endif
+    if (!(banded_difference < 1e-10))
+    {
+        std::cerr << "Banded and dense jacobian solutions differ by " << banded_difference << "!" << std::endl;
+        return 1;
+    }
+
+    // explicit Runge-Kutta schemes of butcher tableaux and implicit schemes, orders on the linear test system
+    typedef ode::OdeSys_test_linear<working_precision> linear_eqns;
+    if (!hasOrder<ode::RK4<linear_eqns>>(100, 1.0) || !hasOrder<ode::BogackiShampine<linear_eqns>>(100, 1.0) ||
+        !hasOrder<ode::DormandPrince<linear_eqns>>(100, 1.0) ||
+        !adaptiveChecks<ode::AdaptiveBogackiShampine<decltype(eqns)>>(10, 1.0) ||
+        !adaptiveChecks<ode::AdaptiveDormandPrince<decltype(eqns)>>(10, 1.0))
+    {
+        return 1;
+    }
+    if (!hasOrder<ode::BDF2<linear_eqns>>(100, 1.0) || !hasOrder<ode::TrBdf2<linear_eqns>>(100, 1.0) ||
+        !hasOrder<ode::Ros2<linear_eqns>>(100, 1.0) || !hasOrder<ode::Rodas3<linear_eqns>>(100, 1.0))
+    {
+        return 1;
+    }
+
+    if (!sparseChecks() || !metaChecks())
+    {
+        return 1;
+    }
+
+    // every lane of batched LSE (including padding of the last partial batch) has to match LSE of the scalar scheme
+    typedef siqrd::OdeSys_SIQRD_batch<working_precision> siqrd_batch;
+    typedef siqrd::OdeSys_SIQRD<working_precision> siqrd_eqns;
+    if (!lanesMatchScalar<ode::HeunBatch<siqrd_batch>, ode::Heun<siqrd_eqns>>() ||
+        !lanesMatchScalar<ode::EulerForwardBatch<siqrd_batch>, ode::EulerForward<siqrd_eqns>>() ||
+        !adjointMatchesSensitivity<ode::TrBdf2<siqrd_eqns>>() || !pooledGradientMatchesSerial<ode::Heun<siqrd_eqns>>())
+    {
+        return 1;
+    }
+
+    // sensitivity gradient of every scheme of batch, Rosenbrock schemes differentiate through the block diagonal
+    // jacobian of the sensitivity system, so they have no exact sensitivities and LSE_siqrd rejects them
+    static_assert(!ode::exact_sensitivity<ode::Ros2<siqrd_eqns>>::value && !ode::exact_sensitivity<ode::Rodas3<siqrd_eqns>>::value,
+                  "Rosenbrock sensitivities are not derivatives of the discrete solution");
+    static_assert(!ode::has_adjoint<ode::BDF2<siqrd_eqns>>::value && !ode::has_adjoint<ode::Ros2<siqrd_eqns>>::value &&
+                      !ode::has_adjoint<ode::AdaptiveDormandPrince<siqrd_eqns>>::value && ode::has_adjoint<ode::TrBdf2<siqrd_eqns>>::value,
+                  "discrete adjoint is declared by the schemes having one");
+    if (!sensitivityMatchesDifferences<ode::EulerForward<siqrd_eqns>>() || !sensitivityMatchesDifferences<ode::EulerBackward<siqrd_eqns>>() ||
+        !sensitivityMatchesDifferences<ode::EulerBackward<siqrd_eqns, ode::simplified_newton>>() ||
+        !sensitivityMatchesDifferences<ode::Heun<siqrd_eqns>>() || !sensitivityMatchesDifferences<ode::RK4<siqrd_eqns>>() ||
+        !sensitivityMatchesDifferences<ode::BogackiShampine<siqrd_eqns>>() || !sensitivityMatchesDifferences<ode::DormandPrince<siqrd_eqns>>() ||
+        !sensitivityMatchesDifferences<ode::AdaptiveBogackiShampine<siqrd_eqns>>() ||
+        !sensitivityMatchesDifferences<ode::AdaptiveDormandPrince<siqrd_eqns>>() || !sensitivityMatchesDifferences<ode::BDF2<siqrd_eqns>>() ||
+        !sensitivityMatchesDifferences<ode::TrBdf2<siqrd_eqns>>())
+    {
+        return 1;
+    }
+#ifndef NINFO
+    std::cout << "Sensitivity gradients of all schemes match central differences." << std::endl
+              << std::endl;
+#endif
+
+#ifdef NDEBUG // ublas type checks of debug build allocate
+    if (solve_allocations != 0)
+    {
+        std::cerr << "Solvers made " << solve_allocations << " heap allocations!" << std::endl;
+        return 1;
+    }
+
+    // fitting hot path: LSE value, bounded value, finite difference, sensitivity and adjoint gradient
+    const std::size_t lse_allocations = lseAllocations<ode::Heun<siqrd_eqns>>() +
+                                        lseAllocations<ode::EulerBackward<siqrd_eqns, ode::simplified_newton>>();
+    if (lse_allocations != 0)
+    {
+        std::cerr << "LSE evaluations and gradients made " << lse_allocations << " heap allocations!" << std::endl;
+        return 1;
+    }
+#endif
+
 #ifndef NINFO
     std::cout << "Program finished." << std::endl;
 #endif
@@ -0,0 +1,52 @@
+/*
+    Name:     sweep
+    Purpose:  Simulates SIQRD equations with Heun's method for every combination of parameters on a grid, in parallel,
+              and writes summary metrics instead of trajectories - peak of infected, its time, final deaths and attack rate.
+    Author:   pavel.macak@fs.cvut.cz
+    Compilation: Makefile is provided - make run8 to run after compilation, make sweep to only compile.
+    Command line arguments: (0-5) Grid file (default 'inputs/sweep_grid.in'), number of time steps (default 1000),
+                            final simulation time (default 100), number of threads (default all cores)
+                            and output file (default 'outputs/heun_sweep.out').
+    Input files: 'sweep_grid.in', 'parameters.in'
+    Output files: Yes
+*/
+
+#include "debug_levels.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "ode/heun.hpp"
+
+#include "siqrd/odeSys_siqrd.hpp"
+#include "siqrd/scenarioSweep.hpp"
+
+int main(int argc, char const *argv[])
+{
+    typedef double working_precision;
+    assert(argc <= 6);
+
+    const std::string grid_file = argc > 1 ? argv[1] : "inputs/sweep_grid.in";
+    const int N = argc > 2 ? std::stoi(argv[2]) : 1000;
+    const working_precision T = argc > 3 ? std::stod(argv[3]) : 100.0;
+    const unsigned no_threads = argc > 4 ? std::stoi(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+    const std::string out_file = argc > 5 ? argv[5] : "outputs/heun_sweep.out";
+    assert(N > 0);
+    assert(T > 0);
+
+    typedef typename ode::Heun<siqrd::OdeSys_SIQRD<working_precision>> heun;
+#ifndef NINFO
+    const auto start = std::chrono::steady_clock::now();
+#endif
+    const auto no_points = siqrd::runSweep<heun>(grid_file, "inputs/parameters.in", N, T, out_file, no_threads);
+    if (no_points == 0)
+        return 1;
+#ifndef NINFO
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << no_points << " scenarios simulated in " << elapsed.count() << " s, summary written to " << out_file << std::endl;
+#endif
+    return 0;
+}